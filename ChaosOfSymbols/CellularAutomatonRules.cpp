@@ -2,85 +2,363 @@
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include "CellularAutomatonRules.h"
 #include "Logger.h"
+#ifndef RULE_CODEGEN
+#include "GeneratedRules.h" // генератор собирается без него, чтобы не зависеть от своего же вывода
+#endif
+
+namespace {
+    /// <summary>
+    /// Однопроходный компилятор строки правила в программу для стековой машины.
+    /// Грамматика (по убыванию приоритета):
+    ///   expr    := andExpr ('||' andExpr)*
+    ///   andExpr := unary ('&&' unary)*
+    ///   unary   := '!' unary | '(' expr ')' | 'true' | 'false' | compare
+    ///   compare := operand [('<' | '<=' | '>' | '>=' | '==' | '!=') operand]
+    ///   operand := count['c'] | число
+    /// </summary>
+    class RuleCompiler {
+    public:
+        RuleCompiler(const std::string& source, std::vector<RuleInstruction>& program)
+            : m_source(source), m_pos(0), m_depth(0), m_maxDepth(0), m_program(program) {}
+
+        bool Compile(std::string& error, int& stackDepth) {
+            SkipSpaces();
+            if (m_pos < m_source.size()) {
+                ParseOr();
+                SkipSpaces();
+                if (m_error.empty() && m_pos < m_source.size()) {
+                    Fail("unexpected '" + std::string(1, m_source[m_pos]) + "'");
+                }
+            }
+            else {
+                // Пустое правило всегда истинно
+                Emit(RuleOpCode::PushConst, '\0', 1, 1);
+            }
+
+            error = m_error;
+            stackDepth = m_maxDepth;
+            return m_error.empty();
+        }
+
+    private:
+        void ParseOr() {
+            ParseAnd();
+            while (m_error.empty() && Match("||")) {
+                ParseAnd();
+                Emit(RuleOpCode::Or, '\0', 0, -1);
+            }
+        }
+
+        void ParseAnd() {
+            ParseUnary();
+            while (m_error.empty() && Match("&&")) {
+                ParseUnary();
+                Emit(RuleOpCode::And, '\0', 0, -1);
+            }
+        }
+
+        void ParseUnary() {
+            SkipSpaces();
+            if (Match("!")) {
+                ParseUnary();
+                Emit(RuleOpCode::Not, '\0', 0, 0);
+            }
+            else if (Match("(")) {
+                ParseOr();
+                if (m_error.empty() && !Match(")")) {
+                    Fail("missing ')'");
+                }
+            }
+            else if (MatchWord("true")) {
+                Emit(RuleOpCode::PushConst, '\0', 1, 1);
+            }
+            else if (MatchWord("false")) {
+                Emit(RuleOpCode::PushConst, '\0', 0, 1);
+            }
+            else {
+                ParseCompare();
+            }
+        }
+
+        void ParseCompare() {
+            bool leftIsCount = false;
+            char leftTile = '\0';
+            int leftValue = 0;
+            if (!ParseOperand(leftIsCount, leftTile, leftValue)) return;
+
+            int cmp = ParseCompareOperator();
+            if (cmp < 0) {
+                // Одиночный операнд трактуется как "!= 0"
+                if (leftIsCount) {
+                    Emit(RuleOpCode::CountNotEqual, leftTile, 0, 1);
+                }
+                else {
+                    Emit(RuleOpCode::PushConst, '\0', leftValue != 0, 1);
+                }
+                return;
+            }
+
+            bool rightIsCount = false;
+            char rightTile = '\0';
+            int rightValue = 0;
+            if (!ParseOperand(rightIsCount, rightTile, rightValue)) return;
+
+            // Частый случай count['x'] <op> N сворачивается в одну инструкцию
+            if (leftIsCount && !rightIsCount) {
+                Emit(static_cast<RuleOpCode>(static_cast<int>(RuleOpCode::CountLess) + cmp), leftTile, rightValue, 1);
+                return;
+            }
+
+            EmitOperand(leftIsCount, leftTile, leftValue);
+            EmitOperand(rightIsCount, rightTile, rightValue);
+            Emit(static_cast<RuleOpCode>(static_cast<int>(RuleOpCode::Less) + cmp), '\0', 0, -1);
+        }
+
+        bool ParseOperand(bool& isCount, char& tile, int& value) {
+            SkipSpaces();
+            if (MatchWord("count")) {
+                SkipSpaces();
+                if (!Match("[")) return Fail("expected '[' after count");
+                SkipSpaces();
+                if (m_pos >= m_source.size() || (m_source[m_pos] != '\'' && m_source[m_pos] != '"')) {
+                    return Fail("expected quoted tile character");
+                }
+                char quote = m_source[m_pos];
+                if (m_pos + 2 >= m_source.size() || m_source[m_pos + 2] != quote) {
+                    return Fail("expected single tile character in count[...]");
+                }
+                tile = m_source[m_pos + 1];
+                m_pos += 3;
+                SkipSpaces();
+                if (!Match("]")) return Fail("expected ']'");
+                isCount = true;
+                return true;
+            }
+
+            size_t start = m_pos;
+            if (m_pos < m_source.size() && m_source[m_pos] == '-') m_pos++;
+            while (m_pos < m_source.size() && std::isdigit(static_cast<unsigned char>(m_source[m_pos]))) m_pos++;
+            if (m_pos == start || (m_pos == start + 1 && m_source[start] == '-')) {
+                m_pos = start;
+                return Fail(m_pos < m_source.size()
+                    ? "unexpected '" + std::string(1, m_source[m_pos]) + "'"
+                    : "unexpected end of rule");
+            }
+
+            // Конфиг перезагружается на лету: опечатка в числе должна делать правило недействительным, а не бросать
+            errno = 0;
+            long number = std::strtol(m_source.c_str() + start, nullptr, 10);
+            if (errno == ERANGE || number < INT_MIN || number > INT_MAX) {
+                m_pos = start;
+                return Fail("number out of range");
+            }
+            value = static_cast<int>(number);
+            isCount = false;
+            return true;
+        }
+
+        /// <returns>смещение от Less (0..5) или -1, если оператора нет</returns>
+        int ParseCompareOperator() {
+            SkipSpaces();
+            if (Match("<=")) return 1;
+            if (Match(">=")) return 3;
+            if (Match("==")) return 4;
+            if (Match("!=")) return 5;
+            if (Match("<")) return 0;
+            if (Match(">")) return 2;
+            return -1;
+        }
+
+        void EmitOperand(bool isCount, char tile, int value) {
+            if (isCount) {
+                Emit(RuleOpCode::PushCount, tile, 0, 1);
+            }
+            else {
+                Emit(RuleOpCode::PushConst, '\0', value, 1);
+            }
+        }
+
+        void Emit(RuleOpCode op, char tile, int value, int stackEffect) {
+            m_program.push_back({ op, tile, NeighborCounts::NoSlot, value });
+            m_depth += stackEffect;
+            m_maxDepth = std::max(m_maxDepth, m_depth);
+        }
+
+        void SkipSpaces() {
+            while (m_pos < m_source.size() && std::isspace(static_cast<unsigned char>(m_source[m_pos]))) m_pos++;
+        }
+
+        bool Match(const char* token) {
+            SkipSpaces();
+            size_t length = std::strlen(token);
+            if (m_source.compare(m_pos, length, token) == 0) {
+                m_pos += length;
+                return true;
+            }
+            return false;
+        }
+
+        bool MatchWord(const char* word) {
+            size_t length = std::strlen(word);
+            if (m_source.compare(m_pos, length, word) != 0) return false;
+            size_t end = m_pos + length;
+            if (end < m_source.size() && (std::isalnum(static_cast<unsigned char>(m_source[end])) || m_source[end] == '_')) {
+                return false;
+            }
+            m_pos = end;
+            return true;
+        }
+
+        bool Fail(const std::string& message) {
+            if (m_error.empty()) {
+                m_error = message + " at position " + std::to_string(m_pos);
+            }
+            return false;
+        }
+
+        const std::string& m_source;
+        size_t m_pos;
+        int m_depth;
+        int m_maxDepth;
+        std::string m_error;
+        std::vector<RuleInstruction>& m_program;
+    };
+}
 
 /// <summary>
-/// Выполняет оценку правила клеточного автомата на основе counts соседей
+/// Компилирует строку правила в программу один раз при загрузке конфига
 /// </summary>
-bool RuleParser::evaluate(const std::unordered_map<char, int>& neighborCounts) const {
-    if (m_ruleString.empty() || m_ruleString == "true") return true;
-    if (m_ruleString == "false") return false;
+void RuleParser::compile() {
+    m_program.clear();
+    m_error.clear();
 
-    // Простой парсер для условий типа "count['#'] >= 2 && count['~'] == 1"
-    size_t andPos = m_ruleString.find("&&");
-    size_t orPos = m_ruleString.find("||");
+    RuleCompiler compiler(m_ruleString, m_program);
+    m_isValid = compiler.Compile(m_error, m_stackDepth);
 
-    if (andPos != std::string::npos) {
-        std::string left = m_ruleString.substr(0, andPos);
-        std::string right = m_ruleString.substr(andPos + 2);
-        return parseCondition(left, neighborCounts) && parseCondition(right, neighborCounts);
+    if (m_isValid && m_stackDepth > MaxStackDepth) {
+        m_isValid = false;
+        m_error = "rule is nested too deeply (stack depth " + std::to_string(m_stackDepth) + ")";
     }
-    else if (orPos != std::string::npos) {
-        std::string left = m_ruleString.substr(0, orPos);
-        std::string right = m_ruleString.substr(orPos + 2);
-        return parseCondition(left, neighborCounts) || parseCondition(right, neighborCounts);
+
+    if (!m_isValid) {
+        m_program.clear();
     }
-    else {
-        return parseCondition(m_ruleString, neighborCounts);
+
+    m_referencedTiles.clear();
+    for (const RuleInstruction& instruction : m_program) {
+        bool readsCount = instruction.op == RuleOpCode::PushCount ||
+            (instruction.op >= RuleOpCode::CountLess && instruction.op <= RuleOpCode::CountNotEqual);
+        if (readsCount && m_referencedTiles.find(instruction.tile) == std::string::npos) {
+            m_referencedTiles += instruction.tile;
+        }
     }
+    std::sort(m_referencedTiles.begin(), m_referencedTiles.end());
 }
 
 /// <summary>
-/// Парсит отдельное условие вида "count['#'] >= 2" и проверяет его выполнение
+/// Выполняет скомпилированное правило на стековой машине по counts соседей
 /// </summary>
-bool RuleParser::parseCondition(const std::string& condition, const std::unordered_map<char, int>& counts) const {
-    std::string trimmed = condition;
-    trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-    trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
+bool RuleParser::evaluate(const NeighborCounts& neighborCounts) const {
+    if (!m_isValid) return false;
+    if (m_kernel) return m_kernel(neighborCounts, m_kernelSlots.data());
+
+    int stack[MaxStackDepth];
+    int top = -1;
+
+    for (const RuleInstruction& instruction : m_program) {
+        switch (instruction.op) {
+        case RuleOpCode::PushConst:         stack[++top] = instruction.value; break;
+        case RuleOpCode::PushCount:         stack[++top] = neighborCounts.Get(instruction.slot); break;
+        case RuleOpCode::CountLess:         stack[++top] = neighborCounts.Get(instruction.slot) < instruction.value; break;
+        case RuleOpCode::CountLessEqual:    stack[++top] = neighborCounts.Get(instruction.slot) <= instruction.value; break;
+        case RuleOpCode::CountGreater:      stack[++top] = neighborCounts.Get(instruction.slot) > instruction.value; break;
+        case RuleOpCode::CountGreaterEqual: stack[++top] = neighborCounts.Get(instruction.slot) >= instruction.value; break;
+        case RuleOpCode::CountEqual:        stack[++top] = neighborCounts.Get(instruction.slot) == instruction.value; break;
+        case RuleOpCode::CountNotEqual:     stack[++top] = neighborCounts.Get(instruction.slot) != instruction.value; break;
+        case RuleOpCode::Less:              top--; stack[top] = stack[top] < stack[top + 1]; break;
+        case RuleOpCode::LessEqual:         top--; stack[top] = stack[top] <= stack[top + 1]; break;
+        case RuleOpCode::Greater:           top--; stack[top] = stack[top] > stack[top + 1]; break;
+        case RuleOpCode::GreaterEqual:      top--; stack[top] = stack[top] >= stack[top + 1]; break;
+        case RuleOpCode::Equal:             top--; stack[top] = stack[top] == stack[top + 1]; break;
+        case RuleOpCode::NotEqual:          top--; stack[top] = stack[top] != stack[top + 1]; break;
+        case RuleOpCode::And:               top--; stack[top] = stack[top] && stack[top + 1]; break;
+        case RuleOpCode::Or:                top--; stack[top] = stack[top] || stack[top + 1]; break;
+        case RuleOpCode::Not:               stack[top] = !stack[top]; break;
+        }
+    }
 
-    size_t bracketStart = trimmed.find("count['");
-    if (bracketStart == std::string::npos) return false;
+    return top >= 0 && stack[top] != 0;
+}
 
-    size_t bracketEnd = trimmed.find("']", bracketStart);
-    if (bracketEnd == std::string::npos) return false;
+/// <summary>
+/// Заменяет символы тайлов в программе на слоты NeighborCounts
+/// </summary>
+void RuleParser::bindSlots(const std::array<NeighborCounts::Slot, 256>& slotByChar) {
+    for (RuleInstruction& instruction : m_program) {
+        instruction.slot = slotByChar[static_cast<unsigned char>(instruction.tile)];
+    }
+    for (size_t i = 0; i < m_kernelCharacters.size(); i++) {
+        m_kernelSlots[i] = slotByChar[static_cast<unsigned char>(m_kernelCharacters[i])];
+    }
+}
 
-    char tileChar = trimmed[bracketStart + 7]; // после "count['"
-    std::string rest = trimmed.substr(bracketEnd + 2);
+/// <summary>
+/// Подключает сгенерированное правило; слоты его символов назначаются в bindSlots
+/// </summary>
+void RuleParser::attachKernel(CompiledRule kernel, const std::string& kernelCharacters) {
+    m_kernel = kernel;
+    m_kernelCharacters = kernelCharacters;
+    m_kernelSlots.assign(std::max<size_t>(1, kernelCharacters.size()), NeighborCounts::NoSlot);
+}
 
-    // Убираем пробелы
-    rest.erase(std::remove(rest.begin(), rest.end(), ' '), rest.end());
+/// <summary>
+/// Вероятность срабатывания правила. Порог сравнивается с 64-битным случайным числом клетки
+/// </summary>
+void RuleParser::setProbability(double probability) {
+    m_probability = std::max(0.0, std::min(1.0, probability));
+    m_chanceThreshold = m_probability < 1.0
+        ? static_cast<std::uint64_t>(m_probability * 18446744073709551616.0) // 2^64
+        : UINT64_MAX;
+}
 
-    // Парсим оператор и значение
-    std::string op;
-    std::string valueStr;
+/// <summary>
+/// Отделяет необязательную вероятность правила: "0.3 : count['.'] >= 2" -> 0.3 и "count['.'] >= 2".
+/// Двоеточие внутри выражения (count[':']) вероятностью не считается. false - вероятность вне [0, 1]
+/// </summary>
+bool CellularAutomatonConfig::SplitProbability(std::string& value, double& probability) {
+    probability = 1.0;
 
-    for (size_t i = 0; i < rest.size(); ++i) {
-        if (std::isdigit(rest[i])) {
-            op = rest.substr(0, i);
-            valueStr = rest.substr(i);
-            break;
-        }
+    size_t colonPos = value.find(':');
+    if (colonPos == std::string::npos) {
+        return true;
     }
 
-    if (op.empty() || valueStr.empty()) return false;
-
-    int value = std::stoi(valueStr);
-    int actualCount = 0;
-
-    std::unordered_map<char, int>::const_iterator it = counts.find(tileChar);
-    if (it != counts.end()) {
-        actualCount = it->second;
+    std::string prefix = value.substr(0, colonPos);
+    prefix.erase(0, prefix.find_first_not_of(" \t"));
+    prefix.erase(prefix.find_last_not_of(" \t") + 1);
+    if (prefix.empty()) {
+        return true;
     }
 
-    if (op == "==") return actualCount == value;
-    if (op == ">=") return actualCount >= value;
-    if (op == "<=") return actualCount <= value;
-    if (op == ">") return actualCount > value;
-    if (op == "<") return actualCount < value;
-    if (op == "!=") return actualCount != value;
+    char* end = nullptr;
+    double parsed = std::strtod(prefix.c_str(), &end);
+    if (*end != '\0') {
+        return true;
+    }
+    if (parsed < 0.0 || parsed > 1.0) {
+        return false;
+    }
 
-    return false;
+    probability = parsed;
+    value = value.substr(colonPos + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    return true;
 }
 
 /// <summary>
@@ -96,6 +374,9 @@ bool CellularAutomatonConfig::LoadFromFile(const std::string& filename) {
     }
 
     m_rules.clear();
+    m_outcomeTable = RuleOutcomeTable();
+    m_stochastic = false;
+    m_revision++;
 
     std::string line;
     char currentTile = '\0';
@@ -151,18 +432,36 @@ bool CellularAutomatonConfig::LoadFromFile(const std::string& filename) {
             continue;
         }
 
+        double probability = 1.0;
+        if (!SplitProbability(value, probability)) {
+            Logger::Log("ERROR: Rule probability must be between 0 and 1 at line " + std::to_string(lineNumber) +
+                ", rule ignored");
+            continue;
+        }
+
+        std::shared_ptr<RuleParser> compiled;
         if (key == "survival") {
-            currentRule.survivalRule = RuleParser::create(value);
+            compiled = currentRule.survivalRule = RuleParser::create(value);
         }
         else if (key == "birth") {
-            currentRule.birthRule = RuleParser::create(value);
+            compiled = currentRule.birthRule = RuleParser::create(value);
         }
         else if (key == "death") {
-            currentRule.deathRule = RuleParser::create(value);
+            compiled = currentRule.deathRule = RuleParser::create(value);
         }
         else {
             Logger::Log("WARNING: Unknown key: " + key);
         }
+
+        if (compiled && probability < 1.0) {
+            compiled->setProbability(probability);
+            m_stochastic = true;
+        }
+
+        if (compiled && !compiled->isValid()) {
+            Logger::Log("ERROR: Invalid " + key + " rule at line " + std::to_string(lineNumber) +
+                ": " + compiled->getError() + " (rule always evaluates to false)");
+        }
     }
 
     // Сохраняем последнее правило после окончания файла
@@ -173,6 +472,8 @@ bool CellularAutomatonConfig::LoadFromFile(const std::string& filename) {
 
     file.close();
     LogRulesSummary();
+    CollectReferencedTiles();
+    AttachGeneratedKernels(filename);
 
     // Дополнительная отладочная информация
     Logger::Log("DEBUG: Total rules loaded: " + std::to_string(m_rules.size()));
@@ -183,6 +484,77 @@ bool CellularAutomatonConfig::LoadFromFile(const std::string& filename) {
     return !m_rules.empty();
 }
 
+/// <summary>
+/// Зависимости правил: какие тайлы читает count['x'] хотя бы одного правила.
+/// Соседи остальных тайлов не влияют ни на одно правило, и World их не считает
+/// </summary>
+void CellularAutomatonConfig::CollectReferencedTiles() {
+    m_referencedTiles.clear();
+    for (const auto& pair : m_rules) {
+        const CellRule& rule = pair.second;
+        for (const RuleParser* parser : { rule.survivalRule.get(), rule.birthRule.get(), rule.deathRule.get() }) {
+            if (!parser) continue;
+
+            for (char tile : parser->getReferencedTiles()) {
+                if (m_referencedTiles.find(tile) == std::string::npos) {
+                    m_referencedTiles += tile;
+                }
+            }
+        }
+    }
+    std::sort(m_referencedTiles.begin(), m_referencedTiles.end());
+
+    Logger::Log("Rules read neighbor counts of " + std::to_string(m_referencedTiles.size()) + " tile types: '" +
+        m_referencedTiles + "'");
+}
+
+/// <summary>
+/// FNV-1a по байтам файла; 0, если файл не открылся. Тем же хешем генератор помечает GeneratedRules.h
+/// </summary>
+std::uint64_t CellularAutomatonConfig::HashFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    char byte;
+    while (file.get(byte)) {
+        hash = (hash ^ static_cast<unsigned char>(byte)) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/// <summary>
+/// Подключает скомпилированные правила из GeneratedRules.h, если файл не менялся после сборки.
+/// Отредактированный на лету конфиг вычисляется стековой машиной RuleParser
+/// </summary>
+void CellularAutomatonConfig::AttachGeneratedKernels(const std::string& filename) {
+#ifndef RULE_CODEGEN
+    if (HashFile(filename) != GeneratedRules::SourceHash) {
+        Logger::Log("Generated rule kernels do not match " + filename + " (edited since build), using the rule interpreter");
+        return;
+    }
+
+    int attached = 0;
+    for (const GeneratedRuleKernel* kernel = GeneratedRules::Kernels; kernel->evaluate; kernel++) {
+        auto it = m_rules.find(kernel->tile);
+        if (it == m_rules.end()) continue;
+
+        std::string key = kernel->key;
+        CellRule& rule = it->second;
+        std::shared_ptr<RuleParser> parser = key == "survival" ? rule.survivalRule
+            : key == "birth" ? rule.birthRule
+            : key == "death" ? rule.deathRule : nullptr;
+        if (parser) {
+            parser->attachKernel(kernel->evaluate, GeneratedRules::Characters);
+            attached++;
+        }
+    }
+    Logger::Log("Using " + std::to_string(attached) + " generated rule kernels for " + filename);
+#else
+    (void)filename;
+#endif
+}
+
 /// <summary>
 /// Получает правила для конкретного типа тайла
 /// </summary>
@@ -194,6 +566,131 @@ const CellRule* CellularAutomatonConfig::GetRule(char tileChar) const {
     return nullptr;
 }
 
+/// <summary>
+/// Привязывает все загруженные правила к слотам текущего набора тайлов
+/// </summary>
+void CellularAutomatonConfig::BindTileSlots(const std::array<NeighborCounts::Slot, 256>& slotByChar) {
+    for (auto& pair : m_rules) {
+        CellRule& rule = pair.second;
+        if (rule.survivalRule) rule.survivalRule->bindSlots(slotByChar);
+        if (rule.birthRule) rule.birthRule->bindSlots(slotByChar);
+        if (rule.deathRule) rule.deathRule->bindSlots(slotByChar);
+    }
+}
+
+/// <summary>
+/// Перебирает все входы правил (состояние клетки и count каждого упомянутого слота от 0 до maxNeighborCount)
+/// и строит плотную таблицу исходов. Вызывается после BindTileSlots с тем же slotByChar.
+/// Возвращает false, если таблица не помещается в memoryLimitBytes
+/// </summary>
+bool CellularAutomatonConfig::BuildOutcomeTable(const std::array<NeighborCounts::Slot, 256>& slotByChar,
+    int maxNeighborCount, size_t memoryLimitBytes) {
+    m_outcomeTable = RuleOutcomeTable();
+
+    // Измерения таблицы - только слоты, которые читают правила, а состояния - только тайлы с правилами:
+    // тайлы без правил делят одно состояние. Порядок рождения совпадает с обходом m_rules
+    RuleOutcomeTable table;
+    for (const auto& pair : m_rules) {
+        if (slotByChar[static_cast<unsigned char>(pair.first)] != NeighborCounts::NoSlot) {
+            table.stateTiles.push_back(pair.first);
+        }
+    }
+    std::sort(table.stateTiles.begin(), table.stateTiles.end(), [&slotByChar](char a, char b) {
+        return slotByChar[static_cast<unsigned char>(a)] < slotByChar[static_cast<unsigned char>(b)];
+    });
+
+    for (const auto& pair : m_rules) {
+        const CellRule& rule = pair.second;
+        for (const RuleParser* parser : { rule.survivalRule.get(), rule.birthRule.get(), rule.deathRule.get() }) {
+            if (!parser) continue;
+
+            for (const RuleInstruction& instruction : parser->getProgram()) {
+                bool readsCount = instruction.op == RuleOpCode::PushCount ||
+                    (instruction.op >= RuleOpCode::CountLess && instruction.op <= RuleOpCode::CountNotEqual);
+                if (readsCount && instruction.slot != NeighborCounts::NoSlot &&
+                    std::find(table.slots.begin(), table.slots.end(), instruction.slot) == table.slots.end()) {
+                    table.slots.push_back(instruction.slot);
+                }
+            }
+        }
+
+        if (rule.birthRule && slotByChar[static_cast<unsigned char>(pair.first)] != NeighborCounts::NoSlot) {
+            table.birthTiles.push_back(pair.first);
+        }
+    }
+    std::sort(table.slots.begin(), table.slots.end());
+
+    if (table.birthTiles.size() > static_cast<size_t>(RuleOutcomeTable::MaxBirthTiles)) {
+        return false;
+    }
+
+    // Последний слот меняется быстрее всего; размер проверяется до выделения памяти
+    size_t countRange = static_cast<size_t>(std::max(0, maxNeighborCount)) + 1;
+    size_t stateCount = table.stateTiles.size() + 2;
+    size_t stride = 1;
+    table.strides.assign(table.slots.size(), 0);
+    for (size_t i = table.slots.size(); i-- > 0;) {
+        table.strides[i] = stride;
+        if (stride > memoryLimitBytes / countRange) {
+            return false;
+        }
+        stride *= countRange;
+    }
+    table.stateStride = stride;
+    if (table.stateStride > memoryLimitBytes / stateCount) {
+        return false;
+    }
+
+    table.outcomes.resize(table.stateStride * stateCount);
+
+    NeighborCounts counts;
+    std::vector<size_t> digits(table.slots.size(), 0);
+    size_t index = 0;
+    for (size_t state = 0; state < stateCount; state++) {
+        for (size_t offset = 0; offset < table.stateStride; offset++) {
+            table.outcomes[index++] = EvaluateOutcome(static_cast<int>(state), counts, table);
+
+            for (size_t i = digits.size(); i-- > 0;) {
+                digits[i] = digits[i] + 1 < countRange ? digits[i] + 1 : 0;
+                counts.counts[table.slots[i]] = static_cast<std::uint16_t>(digits[i]);
+                if (digits[i] != 0) break;
+            }
+        }
+    }
+
+    m_outcomeTable = std::move(table);
+    return true;
+}
+
+/// <summary>
+/// Исход правил для одного входа таблицы - те же проверки, что и в World::StepAutomatonRows
+/// </summary>
+std::uint8_t CellularAutomatonConfig::EvaluateOutcome(int state, const NeighborCounts& counts,
+    const RuleOutcomeTable& table) const {
+    if (state == 0) {
+        for (size_t i = 0; i < table.birthTiles.size(); i++) {
+            const CellRule* rule = GetRule(table.birthTiles[i]);
+            if (rule->birthRule->evaluate(counts)) {
+                return static_cast<std::uint8_t>(RuleOutcomeTable::FirstBirth + i);
+            }
+        }
+        return RuleOutcomeTable::Keep;
+    }
+
+    if (state == table.GetNoRuleState()) return RuleOutcomeTable::Keep;
+
+    const CellRule* rule = GetRule(table.stateTiles[state - 1]);
+    if (!rule) return RuleOutcomeTable::Keep;
+
+    if (rule->deathRule && rule->deathRule->evaluate(counts)) {
+        return RuleOutcomeTable::NaturalDeath;
+    }
+    if (rule->survivalRule && !rule->survivalRule->evaluate(counts)) {
+        return RuleOutcomeTable::Death;
+    }
+    return RuleOutcomeTable::Keep;
+}
+
 /// <summary>
 /// Логирует сводку всех загруженных правил для отладки
 /// </summary>
@@ -206,9 +703,14 @@ void CellularAutomatonConfig::LogRulesSummary() const {
 
         std::string ruleInfo = "Tile '" + std::string(1, tileChar) + "': ";
         bool hasRules = false;
+        auto describe = [](const RuleParser& parser) {
+            return parser.isStochastic()
+                ? "p=" + std::to_string(parser.getProbability()) + " : " + parser.getRuleString()
+                : parser.getRuleString();
+        };
 
         if (rule.survivalRule) {
-            ruleInfo += "\nSurvival=" + rule.survivalRule->getRuleString();
+            ruleInfo += "\nSurvival=" + describe(*rule.survivalRule);
             hasRules = true;
         }
         else {
@@ -216,7 +718,7 @@ void CellularAutomatonConfig::LogRulesSummary() const {
         }
         if (rule.birthRule) {
             if (hasRules) ruleInfo += ", ";
-            ruleInfo += "\nBirth=" + rule.birthRule->getRuleString();
+            ruleInfo += "\nBirth=" + describe(*rule.birthRule);
             hasRules = true;
         }
         else {
@@ -224,7 +726,7 @@ void CellularAutomatonConfig::LogRulesSummary() const {
         }
         if (rule.deathRule) {
             if (hasRules) ruleInfo += ", ";
-            ruleInfo += "\nDeath=" + rule.deathRule->getRuleString();
+            ruleInfo += "\nDeath=" + describe(*rule.deathRule);
             hasRules = true;
         }
         else {
@@ -4,20 +4,76 @@
 #include <functional>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include "NeighborCounts.h"
+
+/// <summary>
+/// Код операции скомпилированного правила (обратная польская запись)
+/// </summary>
+enum class RuleOpCode : unsigned char {
+    PushConst,          // value -> стек
+    PushCount,          // count[tile] -> стек
+    CountLess,          // count[tile] <  value -> стек
+    CountLessEqual,     // count[tile] <= value -> стек
+    CountGreater,       // count[tile] >  value -> стек
+    CountGreaterEqual,  // count[tile] >= value -> стек
+    CountEqual,         // count[tile] == value -> стек
+    CountNotEqual,      // count[tile] != value -> стек
+    Less,               // a <  b
+    LessEqual,          // a <= b
+    Greater,            // a >  b
+    GreaterEqual,       // a >= b
+    Equal,              // a == b
+    NotEqual,           // a != b
+    And,                // a && b
+    Or,                 // a || b
+    Not                 // !a
+};
+
+/// <summary>
+/// Правило, скомпилированное в C++ (tools/RuleCodegen -> GeneratedRules.h).
+/// slots[i] - слот NeighborCounts символа i из списка символов сгенерированного файла
+/// </summary>
+using CompiledRule = bool (*)(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots);
+
+struct GeneratedRuleKernel {
+    char tile;
+    const char* key;        // "survival", "birth" или "death", как в конфиге
+    CompiledRule evaluate;  // nullptr завершает таблицу
+};
+
+struct RuleInstruction {
+    RuleOpCode op;
+    char tile;
+    NeighborCounts::Slot slot; // слот тайла в NeighborCounts, назначается в bindSlots
+    int value;
+};
 
 class RuleParser {
 public:
     // Конструкторы
-    RuleParser() = default;
-    RuleParser(const std::string& ruleStr) : m_ruleString(ruleStr) {}
+    RuleParser() : m_isValid(true), m_stackDepth(0), m_probability(1.0), m_chanceThreshold(0), m_kernel(nullptr) {}
+    RuleParser(const std::string& ruleStr)
+        : m_ruleString(ruleStr), m_isValid(true), m_stackDepth(0), m_probability(1.0), m_chanceThreshold(0), m_kernel(nullptr) {
+        compile();
+    }
 
     // Публичные методы
-    bool evaluate(const std::unordered_map<char, int>& neighborCounts) const;
+    bool evaluate(const NeighborCounts& neighborCounts) const;
+    void bindSlots(const std::array<NeighborCounts::Slot, 256>& slotByChar);
+    void attachKernel(CompiledRule kernel, const std::string& kernelCharacters);
+    void setProbability(double probability);
+
+    /// <summary>
+    /// Срабатывает ли вероятностное правило при случайном числе draw (равномерном на всех 64 битах)
+    /// </summary>
+    bool passesChance(std::uint64_t draw) const { return draw < m_chanceThreshold; }
 
     // Статические методы
     static std::shared_ptr<RuleParser> create(const std::string& ruleStr) {
         auto parser = std::make_shared<RuleParser>();
         parser->m_ruleString = ruleStr;
+        parser->compile();
         return parser;
     }
 
@@ -25,13 +81,37 @@ public:
     const std::string& getRuleString() const {
         return m_ruleString;
     }
+    bool isValid() const { return m_isValid; }
+    const std::string& getError() const { return m_error; }
+    const std::vector<RuleInstruction>& getProgram() const { return m_program; }
+    const std::string& getReferencedTiles() const { return m_referencedTiles; }
+    bool hasKernel() const { return m_kernel != nullptr; }
+    double getProbability() const { return m_probability; }
+    bool isStochastic() const { return m_probability < 1.0; }
+
+    // Константы
+    static constexpr int MaxStackDepth = 32;
 
 private:
     // Приватные методы
-    bool parseCondition(const std::string& condition, const std::unordered_map<char, int>& counts) const;
+    void compile();
 
     // Приватные поля
     std::string m_ruleString;
+    std::vector<RuleInstruction> m_program;
+    std::string m_referencedTiles; // символы count['x'] в программе, по возрастанию
+    std::string m_error;
+    bool m_isValid;
+    int m_stackDepth;
+
+    // Вероятность срабатывания выполненного правила ("birth=0.3 : ..."); 1 - правило детерминировано
+    double m_probability;
+    std::uint64_t m_chanceThreshold; // draw < порога с вероятностью m_probability
+
+    // Сгенерированное правило: вычисляется вместо программы, если конфиг совпал с файлом при сборке
+    CompiledRule m_kernel;
+    std::string m_kernelCharacters;
+    std::vector<NeighborCounts::Slot> m_kernelSlots;
 };
 
 struct CellRule {
@@ -40,18 +120,74 @@ struct CellRule {
     std::shared_ptr<RuleParser> deathRule;
 };
 
+/// <summary>
+/// Таблица исходов правил: (состояние клетки, count по каждому упомянутому в правилах слоту) -> исход.
+/// Состояние 0 - пустая клетка (ID 0), состояние i + 1 - клетка тайла stateTiles[i],
+/// последнее состояние - непустая клетка тайла без правил (всегда Keep)
+/// </summary>
+struct RuleOutcomeTable {
+    // Константы: коды исходов
+    static constexpr std::uint8_t Keep = 0;
+    static constexpr std::uint8_t NaturalDeath = 1; // сработало правило death
+    static constexpr std::uint8_t Death = 2;        // не выполнено правило survival
+    static constexpr std::uint8_t FirstBirth = 3;   // FirstBirth + i - рождение тайла birthTiles[i]
+    static constexpr int MaxBirthTiles = 0x100 - FirstBirth;
+
+    bool IsBuilt() const { return !outcomes.empty(); }
+    size_t GetMemoryBytes() const { return outcomes.size() * sizeof(std::uint8_t); }
+    int GetNoRuleState() const { return static_cast<int>(stateTiles.size()) + 1; }
+
+    std::uint8_t Lookup(int state, const NeighborCounts& counts) const {
+        size_t index = static_cast<size_t>(state) * stateStride;
+        for (size_t i = 0; i < slots.size(); i++) {
+            index += counts.Get(slots[i]) * strides[i];
+        }
+        return outcomes[index];
+    }
+
+    std::vector<std::uint8_t> outcomes;
+    std::vector<NeighborCounts::Slot> slots; // слоты, на которые ссылаются правила
+    std::vector<size_t> strides;
+    size_t stateStride = 0;
+    std::vector<char> birthTiles;            // в порядке проверки правил рождения
+    std::vector<char> stateTiles;            // тайлы с правилами, по возрастанию слота
+};
+
 class CellularAutomatonConfig {
 public:
     // Публичные методы
     bool LoadFromFile(const std::string& filename);
     void LogRulesSummary() const;
 
+    // Статические методы
+    static std::uint64_t HashFile(const std::string& filename);
+
     // Геттеры
     const CellRule* GetRule(char tileChar) const;
     bool HasRules() const { return !m_rules.empty(); }
     const std::unordered_map<char, CellRule>& GetAllRules() const { return m_rules; }
+    int GetRevision() const { return m_revision; }
+    const std::string& GetReferencedTiles() const { return m_referencedTiles; }
+    bool IsStochastic() const { return m_stochastic; }
+
+    const RuleOutcomeTable& GetOutcomeTable() const { return m_outcomeTable; }
+
+    // Привязка символов count['x'] к слотам NeighborCounts текущего набора тайлов
+    void BindTileSlots(const std::array<NeighborCounts::Slot, 256>& slotByChar);
+    bool BuildOutcomeTable(const std::array<NeighborCounts::Slot, 256>& slotByChar,
+        int maxNeighborCount, size_t memoryLimitBytes);
 
 private:
+    // Приватные методы
+    void AttachGeneratedKernels(const std::string& filename);
+    void CollectReferencedTiles();
+    static bool SplitProbability(std::string& value, double& probability);
+    std::uint8_t EvaluateOutcome(int state, const NeighborCounts& counts, const RuleOutcomeTable& table) const;
+
     // Приватные поля
     std::unordered_map<char, CellRule> m_rules;
+    std::string m_referencedTiles; // объединение count['x'] всех правил: только эти тайлы нужно считать
+    RuleOutcomeTable m_outcomeTable;
+    bool m_stochastic = false;     // хотя бы одно правило с вероятностью меньше 1
+    int m_revision = 0;
 };
\ No newline at end of file
@@ -55,6 +55,9 @@ bool ConfigManager::Initialize() {
     m_fileWatcher->WatchFile("config/cellular_automaton.cfg",
         [this]() { this->ReloadAutomatonRules(); });
 
+    m_fileWatcher->WatchFile("config/world_spawn.cfg",
+        [this]() { this->ReloadSpawnRules(); });
+
     m_initialized = true;
     Logger::Log("\nConfigManager initialized successfully");
     return true;
@@ -75,6 +78,10 @@ void ConfigManager::Update() {
 void ConfigManager::ReloadTiles() {
     Logger::Log("Reloading tile configurations...");
 
+    if (OnBeforeReload) {
+        OnBeforeReload();
+    }
+
     //   ID  
     std::unordered_set<int> currentTileIds;
     const auto& currentTiles = m_tileManager->GetAllTiles();
@@ -121,6 +128,10 @@ void ConfigManager::ReloadTiles() {
 void ConfigManager::ReloadFood() {
     Logger::Log("Reloading food configurations...");
 
+    if (OnBeforeReload) {
+        OnBeforeReload();
+    }
+
     if (m_foodManager->LoadFromFile()) {
         Logger::Log("Food configurations reloaded successfully");
         if (OnFoodChanged) {
@@ -138,6 +149,10 @@ void ConfigManager::ReloadFood() {
 void ConfigManager::ReloadAutomatonRules() {
     Logger::Log("Reloading cellular automaton rules...");
 
+    if (OnBeforeReload) {
+        OnBeforeReload();
+    }
+
     if (m_automatonConfig->LoadFromFile("config/cellular_automaton.cfg")) {
         Logger::Log("Cellular automaton rules reloaded successfully");
         if (OnAutomatonRulesChanged) {
@@ -147,4 +162,19 @@ void ConfigManager::ReloadAutomatonRules() {
     else {
         Logger::Log("ERROR: Failed to reload cellular automaton rules");
     }
+}
+
+/// <summary>
+///   :    ,    
+/// </summary>
+void ConfigManager::ReloadSpawnRules() {
+    Logger::Log("Spawn rules changed...");
+
+    if (OnBeforeReload) {
+        OnBeforeReload();
+    }
+
+    if (OnSpawnRulesChanged) {
+        OnSpawnRulesChanged();
+    }
 }
\ No newline at end of file
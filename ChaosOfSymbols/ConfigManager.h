@@ -26,12 +26,15 @@ public:
     std::function<void()> OnTilesChanged;
     std::function<void()> OnFoodChanged;
     std::function<void()> OnAutomatonRulesChanged;
+    std::function<void()> OnSpawnRulesChanged;
+    std::function<void()> OnBeforeReload; //    :  ,   
 
 private:
     //  
     void ReloadTiles();
     void ReloadFood();
     void ReloadAutomatonRules();
+    void ReloadSpawnRules();
 
     //  
     std::unique_ptr<FileWatcher> m_fileWatcher;
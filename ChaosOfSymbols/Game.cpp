@@ -11,6 +11,7 @@
 #include "Logger.h"
 
 static bool rPressed = false;
+static bool fPressed = false;
 
 using namespace std;
 
@@ -23,7 +24,7 @@ Game::Game()
     m_playerX(DefaultPlayerX), m_playerY(DefaultPlayerY), m_playerSteps(0),
     m_playerHP(MAX_HP), m_playerHunger(MAX_HUNGER),
     m_playerXP(0), m_playerLevel(1), m_xpToNextLevel(100),
-    m_totalXP(0)
+    m_totalXP(0), m_fastForward(false), m_fastForwardBatch(1), m_generationCostMs(0.0)
 {
 }
 
@@ -48,6 +49,13 @@ bool Game::Initialize() {
     m_configManager->OnTilesChanged = [this]() { this->OnTilesChanged(); };
     m_configManager->OnFoodChanged = [this]() { this->OnFoodChanged(); };
     m_configManager->OnAutomatonRulesChanged = [this]() { this->OnAutomatonRulesChanged(); };
+    m_configManager->OnSpawnRulesChanged = [this]() { this->OnSpawnRulesChanged(); };
+    m_configManager->OnBeforeReload = [this]() {
+        // Фоновый поток автомата читает тайлы и правила - ждем конца его поколения
+        if (m_currentWorld && !m_automatonPause.owns_lock()) {
+            m_automatonPause = m_currentWorld->PauseAutomaton();
+        }
+    };
 
     TileTypeManager* tileManager = m_configManager->GetTileManager();
     FoodManager* foodManager = m_configManager->GetFoodManager();
@@ -162,8 +170,9 @@ void Game::ProcessInput() {
     if (playerMoved && m_currentWorld->IsAutomatonEnabled()) {
         static int automatonCounter = 0;
         if (++automatonCounter >= 1) {
-            Logger::Log("Player moved - updating cellular automaton");
-            m_currentWorld->UpdateCellularAutomaton();
+            Logger::Log("Player moved - requesting cellular automaton generation");
+            m_currentWorld->SetDetailFocus(m_playerX, m_playerY);
+            m_currentWorld->RequestGenerations(1);
             automatonCounter = 0;
         }
         m_playerSteps++;
@@ -197,6 +206,19 @@ void Game::ProcessInput() {
     else {
         rPressed = false;
     }
+
+    if (GetAsyncKeyState('F') & 0x8000) {
+        if (!fPressed) {
+            m_fastForward = !m_fastForward;
+            m_fastForwardBatch = 1;
+            m_generationCostMs = 0.0;
+            Logger::Log(m_fastForward ? "Fast-forward on" : "Fast-forward off");
+            fPressed = true;
+        }
+    }
+    else {
+        fPressed = false;
+    }
 }
 
 /// <summary>
@@ -233,6 +255,18 @@ void Game::Update() {
 
     if (m_configManager) {
         m_configManager->Update();
+        if (m_automatonPause.owns_lock()) {
+            m_automatonPause.unlock();
+        }
+    }
+
+    // AutomatonFrameBudgetMs > 0: поколение считается здесь кусками строк в пределах бюджета кадра.
+    // При перемотке поколения считает FastForward - начатое здесь поколение он бы тут же бросил
+    if (m_fastForward && m_currentWorld->IsAutomatonEnabled()) {
+        FastForward();
+    }
+    else {
+        m_currentWorld->ContinueGeneration();
     }
 
     if (m_playerHP <= 0) {
@@ -257,6 +291,20 @@ void Game::Update() {
     }
 }
 
+/// <summary>
+/// Перемотка: пачка поколений, которая укладывается в бюджет кадра. Размер пачки подбирается по цене
+/// прошлых пачек, а снимок публикуется один раз в конце - рисуется только последнее состояние
+/// </summary>
+void Game::FastForward() {
+    auto batchStart = chrono::steady_clock::now();
+    m_currentWorld->StepAutomaton(m_fastForwardBatch);
+    double batchMs = chrono::duration<double, milli>(chrono::steady_clock::now() - batchStart).count();
+
+    double costMs = max(batchMs / m_fastForwardBatch, 0.001);
+    m_generationCostMs = m_generationCostMs > 0.0 ? 0.7 * m_generationCostMs + 0.3 * costMs : costMs;
+    m_fastForwardBatch = max(1, min(MaxFastForwardBatch, static_cast<int>(FastForwardBudgetMs / m_generationCostMs)));
+}
+
 /// <summary>
 /// Сбор еды и опыта
 /// </summary>
@@ -311,7 +359,7 @@ void Game::Render() {
     if (uiCounter++ > UiUpdateInterval) {
         m_renderSystem->DrawUI(*m_currentWorld, m_playerX, m_playerY, m_playerSteps,
             m_playerHP, MAX_HP, m_playerHunger, MAX_HUNGER,
-            m_playerXP, m_playerLevel, m_xpToNextLevel);
+            m_playerXP, m_playerLevel, m_xpToNextLevel, m_fastForward);
         uiCounter = 0;
     }
 
@@ -582,6 +630,23 @@ void Game::OnFoodChanged() {
     }
 }
 
+/// <summary>
+/// Обработка изменений правил спавна в реальном времени: тайлы выбираются заново по сохраненным зонам мира
+/// </summary>
+void Game::OnSpawnRulesChanged() {
+    Logger::Log("Spawn rules changed - reselecting terrain tiles...");
+
+    if (!m_currentWorld) return;
+
+    m_currentWorld->ReloadSpawnRules();
+
+    EnsureValidPlayerPosition();
+
+    if (m_renderSystem) {
+        m_renderSystem->ClearScreen();
+    }
+}
+
 /// <summary>
 /// Обработка изменений конфигураций клеточного автомата в реальном времени
 /// </summary>
@@ -591,7 +656,7 @@ void Game::OnAutomatonRulesChanged() {
     if (m_currentWorld && m_configManager->GetAutomatonConfig()) {
         m_currentWorld->SetAutomatonConfig(m_configManager->GetAutomatonConfig());
 
-        m_currentWorld->UpdateCellularAutomaton();
+        m_currentWorld->RequestGenerations(1);
 
         EnsureValidPlayerPosition();
 
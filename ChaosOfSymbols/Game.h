@@ -36,6 +36,7 @@ private:
     void ConsumeEnergy();
     void ShowDeathScreen();
     void CollectFood();
+    void FastForward();
 
     void GainXP(int amount);
     void CheckLevelUp();
@@ -43,6 +44,7 @@ private:
     void OnTilesChanged();
     void OnFoodChanged();
     void OnAutomatonRulesChanged();
+    void OnSpawnRulesChanged();
 
     // Константы
     static constexpr const char* LogFile = "config/debug.log";
@@ -55,6 +57,8 @@ private:
     static constexpr int MaxRandomAttempts = 100;
     static constexpr int EmergencyPositionX = 1;
     static constexpr int EmergencyPositionY = 1;
+    static constexpr int FastForwardBudgetMs = FrameDelayMs * 3 / 4; // остаток кадра - на отрисовку
+    static constexpr int MaxFastForwardBatch = 4096;
    
     // Приватные поля
     bool m_isRunning;
@@ -76,4 +80,8 @@ private:
     int m_playerXP;
     int m_playerLevel;
     int m_xpToNextLevel;
+    std::unique_lock<std::recursive_mutex> m_automatonPause; // держится, пока перезагружаются конфиги
+    bool m_fastForward;          // автомат идет сам, пачками поколений за кадр
+    int m_fastForwardBatch;      // поколений в следующей пачке
+    double m_generationCostMs;   // сглаженная цена поколения в пачке
 };
\ No newline at end of file
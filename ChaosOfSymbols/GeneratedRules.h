@@ -0,0 +1,49 @@
+// Generated by tools/RuleCodegen from config/cellular_automaton.cfg. Do not edit by hand.
+#pragma once
+#include <cstdint>
+#include "CellularAutomatonRules.h"
+
+namespace GeneratedRules {
+    constexpr std::uint64_t SourceHash = 0x4E43561606CF4460ULL;
+    constexpr const char* Characters = "#+.";
+
+    // '#' birth: (count['#'] >= 3 && count['+'] == 0) || (count['.'] <= 3 && count['#'] >= 2)
+    inline bool Rule0(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots) {
+        return ((neighborCounts.Get(slots[0]) >= 3) && (neighborCounts.Get(slots[1]) == 0)) || ((neighborCounts.Get(slots[2]) <= 3) && (neighborCounts.Get(slots[0]) >= 2));
+    }
+
+    // '#' survival: (count['#'] >= 2 && count['#'] <= 5) || (count['#'] == 1 && count['.'] >= 4)
+    inline bool Rule1(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots) {
+        return ((neighborCounts.Get(slots[0]) >= 2) && (neighborCounts.Get(slots[0]) <= 5)) || ((neighborCounts.Get(slots[0]) == 1) && (neighborCounts.Get(slots[2]) >= 4));
+    }
+
+    // '+' birth: (count['+'] >= 2 && count['+'] <= 5) || (count['.'] == 0 && count['#'] <= 2) || (count['.'] >= 2)
+    inline bool Rule2(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots) {
+        return (((neighborCounts.Get(slots[1]) >= 2) && (neighborCounts.Get(slots[1]) <= 5)) || ((neighborCounts.Get(slots[2]) == 0) && (neighborCounts.Get(slots[0]) <= 2))) || (neighborCounts.Get(slots[2]) >= 2);
+    }
+
+    // '+' survival: (count['+'] >= 2 && count['+'] <= 7) || (count['.'] >= 2 && count['+'] >= 2) || (count['.'] >= 4)
+    inline bool Rule3(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots) {
+        return (((neighborCounts.Get(slots[1]) >= 2) && (neighborCounts.Get(slots[1]) <= 7)) || ((neighborCounts.Get(slots[2]) >= 2) && (neighborCounts.Get(slots[1]) >= 2))) || (neighborCounts.Get(slots[2]) >= 4);
+    }
+
+    // '.' birth: (count['.'] >= 2 && count['#'] <= 1)
+    inline bool Rule4(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots) {
+        return (neighborCounts.Get(slots[2]) >= 2) && (neighborCounts.Get(slots[0]) <= 1);
+    }
+
+    // '.' survival: (count['.'] >= 2 && count['.'] <= 5) || (count['.'] == 1 && count['+'] >= 6)
+    inline bool Rule5(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots) {
+        return ((neighborCounts.Get(slots[2]) >= 2) && (neighborCounts.Get(slots[2]) <= 5)) || ((neighborCounts.Get(slots[2]) == 1) && (neighborCounts.Get(slots[1]) >= 6));
+    }
+
+    constexpr GeneratedRuleKernel Kernels[] = {
+        { '#', "birth", Rule0 },
+        { '#', "survival", Rule1 },
+        { '+', "birth", Rule2 },
+        { '+', "survival", Rule3 },
+        { '.', "birth", Rule4 },
+        { '.', "survival", Rule5 },
+        { '\0', nullptr, nullptr }
+    };
+}
@@ -3,6 +3,7 @@
 
 std::ofstream Logger::logFile;
 bool Logger::isInitialized = false;
+std::mutex Logger::logMutex;
 
 void Logger::Initialize(const std::string& filename) {
     if (isInitialized) {
@@ -28,6 +29,7 @@ void Logger::Log(const std::string& message) {
         Initialize();
     }
 
+    std::lock_guard<std::mutex> lock(logMutex);
     if (logFile.is_open()) {
         logFile << message << std::endl;
         logFile.flush();
@@ -2,6 +2,7 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 
 class Logger {
 public:
@@ -12,4 +13,5 @@ public:
 private:
     static std::ofstream logFile;
     static bool isInitialized;
+    static std::mutex logMutex;
 };
\ No newline at end of file
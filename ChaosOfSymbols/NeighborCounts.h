@@ -0,0 +1,27 @@
+#pragma once
+#include <array>
+#include <algorithm>
+#include <cstdint>
+
+/// <summary>
+/// Гистограмма соседей клетки: фиксированный массив по плотному индексу тайла (слоту).
+/// Переиспользуется между клетками, очищаются только занятые слоты.
+/// </summary>
+struct NeighborCounts {
+    using Slot = std::uint8_t;
+
+    // Константы
+    static constexpr int MaxSlots = 256;
+    static constexpr Slot NoSlot = 0xFF;          // символ без тайла: всегда 0
+    static constexpr Slot HaloSlot = 0xFE;        // ореол, граница карты и тайлы вне правил: копится, но не читается и не очищается
+    static constexpr int MaxTileSlots = HaloSlot; // слоты 0..253 доступны под тайлы
+
+    NeighborCounts() { counts.fill(0); }
+
+    void Clear(int slotCount) { std::fill_n(counts.data(), slotCount, static_cast<std::uint16_t>(0)); }
+    void Increment(Slot slot) { counts[slot]++; }
+    void Decrement(Slot slot) { counts[slot]--; }
+    int Get(Slot slot) const { return counts[slot]; }
+
+    std::array<std::uint16_t, MaxSlots> counts;
+};
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cstdlib>
+#include "NeighborShape.h"
+
+/// <summary>
+/// Форма type радиуса radius и ее ядро подсчета. Мур радиуса 0 - прежний фон Нейман радиуса 1,
+/// круг радиуса 1 совпадает с квадратом Мура
+/// </summary>
+NeighborShape NeighborShape::Create(NeighborShapeType type, int radius) {
+    if (type == NeighborShapeType::Moore && radius <= 0) {
+        type = NeighborShapeType::VonNeumann;
+    }
+    if (type == NeighborShapeType::Circle && radius <= 1) {
+        type = NeighborShapeType::Moore;
+    }
+    radius = std::max(1, radius);
+
+    std::vector<NeighborOffset> offsets;
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            if (NeighborShapes::Contains(type, radius, dx, dy)) offsets.push_back({ dx, dy });
+        }
+    }
+
+    Kernel kernel = Kernel::Table;
+    switch (type) {
+    case NeighborShapeType::VonNeumann:
+        if (radius <= 3) kernel = static_cast<Kernel>(static_cast<int>(Kernel::VonNeumann1) + radius - 1);
+        break;
+    case NeighborShapeType::Moore:
+        if (radius <= 3) kernel = static_cast<Kernel>(static_cast<int>(Kernel::Moore1) + radius - 1);
+        break;
+    case NeighborShapeType::Circle:
+        if (radius <= 3) kernel = static_cast<Kernel>(static_cast<int>(Kernel::Circle2) + radius - 2);
+        break;
+    default:
+        break;
+    }
+
+    return NeighborShape(type, radius, std::move(offsets), kernel);
+}
+
+/// <summary>
+/// Форма из явного списка смещений (NeighborMask); всегда считается по таблице
+/// </summary>
+NeighborShape NeighborShape::FromOffsets(const std::vector<NeighborOffset>& offsets) {
+    int radius = 0;
+    for (const NeighborOffset& offset : offsets) {
+        radius = std::max(radius, std::max(std::abs(offset.dx), std::abs(offset.dy)));
+    }
+    return NeighborShape(NeighborShapeType::Custom, std::max(1, radius), offsets, Kernel::Table);
+}
+
+bool NeighborShape::ParseType(const std::string& name, NeighborShapeType& type) {
+    if (name == "Moore") type = NeighborShapeType::Moore;
+    else if (name == "VonNeumann" || name == "Diamond") type = NeighborShapeType::VonNeumann;
+    else if (name == "Circle") type = NeighborShapeType::Circle;
+    else if (name == "Custom") type = NeighborShapeType::Custom;
+    else return false;
+    return true;
+}
+
+/// <summary>
+/// Разбор маски вида "010,101,010": строки квадрата нечетной стороны через запятую, '1' - сосед,
+/// '0' - нет. Центр квадрата - сама клетка, он не считается соседом при любом символе
+/// </summary>
+bool NeighborShape::ParseMask(const std::string& mask, std::vector<NeighborOffset>& offsets) {
+    std::vector<std::string> rows;
+    size_t start = 0;
+    while (start <= mask.size()) {
+        size_t end = mask.find(',', start);
+        if (end == std::string::npos) end = mask.size();
+        rows.push_back(mask.substr(start, end - start));
+        start = end + 1;
+    }
+
+    int side = static_cast<int>(rows.size());
+    if (side % 2 == 0) return false;
+
+    int radius = side / 2;
+    offsets.clear();
+    for (int row = 0; row < side; row++) {
+        if (static_cast<int>(rows[row].size()) != side) return false;
+
+        for (int column = 0; column < side; column++) {
+            char symbol = rows[row][column];
+            if (symbol != '0' && symbol != '1') return false;
+            if (symbol == '1' && (row != radius || column != radius)) {
+                offsets.push_back({ column - radius, row - radius });
+            }
+        }
+    }
+    return !offsets.empty();
+}
+
+const char* NeighborShape::GetTypeName(NeighborShapeType type) {
+    switch (type) {
+    case NeighborShapeType::Moore:      return "Moore";
+    case NeighborShapeType::VonNeumann: return "VonNeumann";
+    case NeighborShapeType::Circle:     return "Circle";
+    default:                            return "Custom";
+    }
+}
+
+std::string NeighborShape::GetDescription() const {
+    return std::string(GetTypeName(m_type)) + " radius " + std::to_string(m_radius) + ", " +
+        std::to_string(GetNeighborCount()) + " neighbors, " + (IsFixedKernel() ? "unrolled kernel" : "offset table");
+}
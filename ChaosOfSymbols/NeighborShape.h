@@ -0,0 +1,179 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "NeighborCounts.h"
+
+/// <summary>
+/// Форма окрестности клетки (ключ NeighborShape в world_gen.cfg)
+/// </summary>
+enum class NeighborShapeType {
+    Moore,      // квадрат (2R+1)^2; радиус 0 - фон Нейман радиуса 1, как раньше
+    VonNeumann, // ромб |dx| + |dy| <= R
+    Circle,     // круг dx^2 + dy^2 <= R(R+1)
+    Custom      // явная маска NeighborMask
+};
+
+struct NeighborOffset {
+    int dx, dy;
+};
+
+namespace NeighborShapes {
+    /// <summary>
+    /// Входит ли смещение (dx, dy) в окрестность формы type радиуса radius (сама клетка не входит)
+    /// </summary>
+    constexpr bool Contains(NeighborShapeType type, int radius, int dx, int dy) {
+        int absX = dx < 0 ? -dx : dx;
+        int absY = dy < 0 ? -dy : dy;
+        if ((dx == 0 && dy == 0) || absX > radius || absY > radius) return false;
+
+        switch (type) {
+        case NeighborShapeType::Moore:      return true;
+        case NeighborShapeType::VonNeumann: return absX + absY <= radius;
+        case NeighborShapeType::Circle:     return dx * dx + dy * dy <= radius * (radius + 1);
+        default:                            return false;
+        }
+    }
+
+    constexpr int CountOffsets(NeighborShapeType type, int radius) {
+        int count = 0;
+        for (int dy = -radius; dy <= radius; dy++) {
+            for (int dx = -radius; dx <= radius; dx++) {
+                if (Contains(type, radius, dx, dy)) count++;
+            }
+        }
+        return count;
+    }
+
+    /// <summary>
+    /// Таблица смещений формы, построенная при компиляции (по строкам сверху вниз)
+    /// </summary>
+    template <NeighborShapeType Type, int Radius>
+    constexpr std::array<NeighborOffset, CountOffsets(Type, Radius)> MakeOffsets() {
+        std::array<NeighborOffset, CountOffsets(Type, Radius)> offsets{};
+        int index = 0;
+        for (int dy = -Radius; dy <= Radius; dy++) {
+            for (int dx = -Radius; dx <= Radius; dx++) {
+                if (Contains(Type, Radius, dx, dy)) offsets[index++] = { dx, dy };
+            }
+        }
+        return offsets;
+    }
+
+    template <NeighborShapeType Type, int Radius>
+    inline constexpr std::array<NeighborOffset, CountOffsets(Type, Radius)> Offsets = MakeOffsets<Type, Radius>();
+
+    /// <summary>
+    /// Ядро подсчета для формы, известной при компиляции: цикл по смещениям полностью развернут,
+    /// смещение каждого соседа - константа, умноженная на шаг строки
+    /// </summary>
+    template <NeighborShapeType Type, int Radius>
+    class FixedKernel {
+    public:
+        explicit FixedKernel(int stride) : m_stride(stride) {}
+
+        template <typename Cell>
+        void Count(const Cell* cell, const NeighborCounts::Slot* slotByTileId, NeighborCounts& counts) const {
+            Add(cell, slotByTileId, counts, std::make_index_sequence<CountOffsets(Type, Radius)>{});
+        }
+
+    private:
+        template <typename Cell, std::size_t... I>
+        void Add(const Cell* cell, const NeighborCounts::Slot* slotByTileId, NeighborCounts& counts,
+            std::index_sequence<I...>) const {
+            constexpr const auto& offsets = Offsets<Type, Radius>;
+            (counts.Increment(slotByTileId[cell[offsets[I].dy * m_stride + offsets[I].dx]]), ...);
+        }
+
+        std::ptrdiff_t m_stride;
+    };
+
+    /// <summary>
+    /// Ядро для произвольной формы: смещения в ячейках пересчитываются под шаг строки один раз
+    /// </summary>
+    class TableKernel {
+    public:
+        TableKernel(const std::vector<NeighborOffset>& offsets, int stride) {
+            m_cellOffsets.reserve(offsets.size());
+            for (const NeighborOffset& offset : offsets) {
+                m_cellOffsets.push_back(static_cast<std::ptrdiff_t>(offset.dy) * stride + offset.dx);
+            }
+        }
+
+        template <typename Cell>
+        void Count(const Cell* cell, const NeighborCounts::Slot* slotByTileId, NeighborCounts& counts) const {
+            for (std::ptrdiff_t offset : m_cellOffsets) {
+                counts.Increment(slotByTileId[cell[offset]]);
+            }
+        }
+
+    private:
+        std::vector<std::ptrdiff_t> m_cellOffsets;
+    };
+}
+
+/// <summary>
+/// Окрестность клетки: список смещений соседей и ядро подсчета, выбранное при создании формы.
+/// Частые формы (фон Нейман и ромб R <= 3, Мур R <= 3, круг R = 2..3) считаются развернутыми
+/// ядрами NeighborShapes::FixedKernel, остальные - по таблице смещений
+/// </summary>
+class NeighborShape {
+public:
+    // Конструктор
+    NeighborShape() : NeighborShape(Create(NeighborShapeType::Moore, 1)) {}
+
+    // Статические методы
+    static NeighborShape Create(NeighborShapeType type, int radius);
+    static NeighborShape FromOffsets(const std::vector<NeighborOffset>& offsets);
+    static bool ParseType(const std::string& name, NeighborShapeType& type);
+    static bool ParseMask(const std::string& mask, std::vector<NeighborOffset>& offsets);
+    static const char* GetTypeName(NeighborShapeType type);
+
+    /// <summary>
+    /// Вызывает func с ядром подсчета для сетки с шагом строки stride. Ядро выбирается один раз
+    /// на проход, а горячий цикл внутри func инстанцируется под каждое ядро отдельно
+    /// </summary>
+    template <typename Func>
+    void Dispatch(int stride, Func&& func) const {
+        using namespace NeighborShapes;
+        using Type = NeighborShapeType;
+
+        switch (m_kernel) {
+        case Kernel::VonNeumann1: func(FixedKernel<Type::VonNeumann, 1>(stride)); break;
+        case Kernel::VonNeumann2: func(FixedKernel<Type::VonNeumann, 2>(stride)); break;
+        case Kernel::VonNeumann3: func(FixedKernel<Type::VonNeumann, 3>(stride)); break;
+        case Kernel::Moore1:      func(FixedKernel<Type::Moore, 1>(stride)); break;
+        case Kernel::Moore2:      func(FixedKernel<Type::Moore, 2>(stride)); break;
+        case Kernel::Moore3:      func(FixedKernel<Type::Moore, 3>(stride)); break;
+        case Kernel::Circle2:     func(FixedKernel<Type::Circle, 2>(stride)); break;
+        case Kernel::Circle3:     func(FixedKernel<Type::Circle, 3>(stride)); break;
+        default:                  func(TableKernel(m_offsets, stride)); break;
+        }
+    }
+
+    // Геттеры
+    NeighborShapeType GetType() const { return m_type; }
+    int GetRadius() const { return m_radius; }
+    int GetNeighborCount() const { return static_cast<int>(m_offsets.size()); }
+    const std::vector<NeighborOffset>& GetOffsets() const { return m_offsets; }
+    bool IsSquare() const { return m_type == NeighborShapeType::Moore; }
+    bool IsVonNeumann(int radius) const { return m_type == NeighborShapeType::VonNeumann && m_radius == radius; }
+    bool IsFixedKernel() const { return m_kernel != Kernel::Table; }
+    std::string GetDescription() const;
+
+private:
+    // Приватные структуры
+    enum class Kernel { VonNeumann1, VonNeumann2, VonNeumann3, Moore1, Moore2, Moore3, Circle2, Circle3, Table };
+
+    // Приватные методы
+    NeighborShape(NeighborShapeType type, int radius, std::vector<NeighborOffset> offsets, Kernel kernel)
+        : m_type(type), m_radius(radius), m_offsets(std::move(offsets)), m_kernel(kernel) {}
+
+    // Приватные поля
+    NeighborShapeType m_type;
+    int m_radius;                           // наибольшее |dx| или |dy| среди соседей
+    std::vector<NeighborOffset> m_offsets;
+    Kernel m_kernel;
+};
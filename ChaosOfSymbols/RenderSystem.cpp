@@ -79,6 +79,7 @@ RenderSystem::RenderSystem(TileTypeManager* tileManager)
 
     // Инициализация статистики
     m_stats.lastFpsUpdate = std::chrono::steady_clock::now();
+    m_stats.lastGenerationUpdate = m_stats.lastFpsUpdate;
     m_stats.fpsHistory.reserve(60); // Храним историю за последние 60 кадров
 }
 
@@ -153,57 +154,68 @@ void RenderSystem::DrawWorld(const World& world) {
         ClearScreen();
     }
 
-    // ОДИН ПРОХОД: сначала рисуем все статические объекты, потом динамические
-    for (int y = 0; y < totalHeight; y++) {
-        for (int x = 0; x < totalWidth; x++) {
-            // Обработка границы
-            if (x == 0 || x == totalWidth - 1 || y == 0 || y == totalHeight - 1) {
-                if (NeedsRedraw(x, y, BORDER_TILE_ID)) {
-                    rlutil::locate(x, y);
-                    rlutil::setColor(15);
-                    std::cout << '#';
-                    m_previousFrame[y][x] = BORDER_TILE_ID;
-                    m_stats.tilesDrawn++;
+    // Снимок держится до конца кадра: фоновый поток тем временем публикует следующие поколения
+    std::shared_ptr<const WorldSnapshot> snapshot = world.GetSnapshot();
+    if (!snapshot) return;
+    const TileGrid& grid = snapshot->grid;
+
+    grid.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
+
+        // ОДИН ПРОХОД: сначала рисуем все статические объекты, потом динамические
+        for (int y = 0; y < totalHeight; y++) {
+            const Cell* row = grid.Row<Cell>(y);
+
+            for (int x = 0; x < totalWidth; x++) {
+                // Обработка границы
+                if (x == 0 || x == totalWidth - 1 || y == 0 || y == totalHeight - 1) {
+                    if (NeedsRedraw(x, y, BORDER_TILE_ID)) {
+                        rlutil::locate(x, y);
+                        rlutil::setColor(15);
+                        std::cout << '#';
+                        m_previousFrame[y][x] = BORDER_TILE_ID;
+                        m_stats.tilesDrawn++;
+                    }
+                    continue;
                 }
-                continue;
-            }
 
-            // Координаты в игровом пространстве
-            int gameX = x - 1;
-            int gameY = y - 1;
-
-            // ПРОВЕРЯЕМ ЕДУ ПЕРВОЙ (динамический объект)
-            const Food* food = world.GetFoodAt(gameX, gameY);
-            if (food) {
-                int foodId = FOOD_TILE_ID_BASE + food->GetId();
-                if (NeedsRedraw(x, y, foodId)) {
-                    rlutil::locate(x, y);
-                    rlutil::setColor(food->GetColor());
-                    std::cout << food->GetSymbol();
-                    m_previousFrame[y][x] = foodId;
-                    m_stats.tilesDrawn++;
-                }
-            }
-            else {
-                // ЕСЛИ ЕДЫ НЕТ - ОТРИСОВЫВАЕМ ТАЙЛ ЗЕМЛИ (статический объект)
-                int tileId = world.GetTileAtFullMap(x, y);
-                if (NeedsRedraw(x, y, tileId)) {
-                    rlutil::locate(x, y);
-                    TileType* tile = m_tileManager->GetTileType(tileId);
-                    if (tile) {
-                        rlutil::setColor(tile->GetColor());
-                        std::cout << tile->GetCharacter();
+                // Координаты в игровом пространстве
+                int gameX = x - 1;
+                int gameY = y - 1;
+
+                // ПРОВЕРЯЕМ ЕДУ ПЕРВОЙ (динамический объект)
+                const Food* food = world.GetFoodAt(gameX, gameY);
+                if (food) {
+                    int foodId = FOOD_TILE_ID_BASE + food->GetId();
+                    if (NeedsRedraw(x, y, foodId)) {
+                        rlutil::locate(x, y);
+                        rlutil::setColor(food->GetColor());
+                        std::cout << food->GetSymbol();
+                        m_previousFrame[y][x] = foodId;
+                        m_stats.tilesDrawn++;
                     }
-                    else {
-                        rlutil::setColor(UnknownTileColor);
-                        std::cout << UnknownTileChar;
+                }
+                else {
+                    // ЕСЛИ ЕДЫ НЕТ - ОТРИСОВЫВАЕМ ТАЙЛ ЗЕМЛИ (статический объект)
+                    int tileId = row[x];
+                    if (NeedsRedraw(x, y, tileId)) {
+                        rlutil::locate(x, y);
+                        const TileType* tile = m_tileManager->GetPalette().GetTile(tileId);
+                        if (tile) {
+                            rlutil::setColor(tile->GetColor());
+                            std::cout << tile->GetCharacter();
+                        }
+                        else {
+                            rlutil::setColor(UnknownTileColor);
+                            std::cout << UnknownTileChar;
+                        }
+                        m_previousFrame[y][x] = tileId;
+                        m_stats.tilesDrawn++;
                     }
-                    m_previousFrame[y][x] = tileId;
-                    m_stats.tilesDrawn++;
                 }
             }
         }
-    }
+    });
 }
 
 /// <summary>
@@ -238,7 +250,7 @@ void RenderSystem::DrawPlayer(int x, int y, int previousX, int previousY, const
             // Если еды не было - восстанавливаем тайл земли
             int tileId = world.GetTileAtFullMap(prevScreenX, prevScreenY);
             rlutil::locate(prevScreenX, prevScreenY);
-            TileType* tile = m_tileManager->GetTileType(tileId);
+            const TileType* tile = m_tileManager->GetPalette().GetTile(tileId);
             if (tile) {
                 rlutil::setColor(tile->GetColor());
                 std::cout << tile->GetCharacter();
@@ -265,11 +277,15 @@ void RenderSystem::DrawPlayer(int x, int y, int previousX, int previousY, const
 /// </summary>
 void RenderSystem::DrawUI(const World& world, int posX, int posY, int playerSteps,
     int playerHP, int playerMaxHP, int playerHunger, int playerMaxHunger,
-    int playerXP, int playerLevel, int xpToNextLevel) {
+    int playerXP, int playerLevel, int xpToNextLevel, bool fastForward) {
 
-    rlutil::locate(0, m_screenHeight);
-    for (int i = 0; i < m_screenWidth; i++) {
-        std::cout << ' ';
+    UpdateGenerationRate(world);
+
+    for (int line = 0; line < 2; line++) {
+        rlutil::locate(0, m_screenHeight + line);
+        for (int i = 0; i < m_screenWidth; i++) {
+            std::cout << ' ';
+        }
     }
 
     rlutil::locate(0, m_screenHeight);
@@ -283,7 +299,39 @@ void RenderSystem::DrawUI(const World& world, int posX, int posY, int playerStep
     std::cout << "Pos: " << posX << "," << posY;
     std::cout << " | Seed: " << world.GetCurrentSeed();
     std::cout << " | FPS: " << static_cast<int>(m_stats.currentFps);
-    std::cout << " | Controls: WASD-move, Q-quit";
+    std::cout << " | Gen: " << m_stats.currentGeneration << " (" << static_cast<int>(m_stats.generationsPerSecond) << "/s)";
+    if (fastForward) {
+        std::cout << " >>";
+    }
+    std::cout << " | Controls: WASD-move, F-fast forward, Q-quit";
+}
+
+/// <summary>
+/// Скорость автомата в поколениях в секунду: по номеру поколения в снимке мира за окно не короче секунды
+/// </summary>
+void RenderSystem::UpdateGenerationRate(const World& world) {
+    std::shared_ptr<const WorldSnapshot> snapshot = world.GetSnapshot();
+    if (!snapshot) {
+        return;
+    }
+
+    m_stats.currentGeneration = snapshot->generation;
+    auto now = std::chrono::steady_clock::now();
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - m_stats.lastGenerationUpdate).count();
+
+    // Новый мир начинает счет поколений заново
+    if (snapshot->generation < m_stats.lastGeneration) {
+        m_stats.lastGeneration = snapshot->generation;
+        m_stats.lastGenerationUpdate = now;
+        m_stats.generationsPerSecond = 0.0;
+        return;
+    }
+
+    if (elapsedMs >= 1000.0) {
+        m_stats.generationsPerSecond = (snapshot->generation - m_stats.lastGeneration) * 1000.0 / elapsedMs;
+        m_stats.lastGeneration = snapshot->generation;
+        m_stats.lastGenerationUpdate = now;
+    }
 }
 
 /// <summary>
@@ -23,7 +23,7 @@ public:
     void ClearScreen();
     void DrawWorld(const World& world);
     void DrawUI(const World& world, int posX, int posY, int playerSteps, int playerHP, int playerMaxHP, int playerHunger, int playerMaxHunger,
-        int playerXP, int playerLevel, int xpToNextLevel);
+        int playerXP, int playerLevel, int xpToNextLevel, bool fastForward);
     void DrawPlayer(int x, int y, int previousX, int previousY, const World& world);
     void SetScreenSize(int width, int height);
     void StartFrame();
@@ -42,6 +42,7 @@ private:
     void InitializePreviousFrame();
     bool NeedsRedraw(int x, int y, int tileId);
     void UpdateFPS();
+    void UpdateGenerationRate(const World& world);
 
     // Приватные структуры
     struct RenderStats {
@@ -55,6 +56,10 @@ private:
         double minFps = 1000.0;
         double maxFps = 0.0;
         std::vector<double> fpsHistory;
+        long long currentGeneration = 0;
+        long long lastGeneration = 0;
+        std::chrono::steady_clock::time_point lastGenerationUpdate;
+        double generationsPerSecond = 0.0;
     };
 
     // Константы
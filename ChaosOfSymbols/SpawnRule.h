@@ -8,4 +8,16 @@ struct SpawnRule {
     std::vector<float> zoneProbabilities; // [низины, равнины, горы]
 
     SpawnRule() : tileId(-1), character('?') {}
+};
+
+/// <summary>
+/// Тайлы зоны высот с нарастающими весами: выбор тайла - поиск первого отрезка, куда попало
+/// случайное значение. Строится один раз при загрузке правил спавна
+/// </summary>
+struct SpawnZoneTable {
+    std::vector<char> tiles;        // в порядке обхода правил спавна
+    std::vector<float> cumulative;  // cumulative[i] - сумма весов tiles[0..i]
+    char fallbackTile = '.';        // самый вероятный тайл зоны: если значение не попало ни в один отрезок
+
+    float GetTotalWeight() const { return cumulative.empty() ? 0.0f : cumulative.back(); }
 };
\ No newline at end of file
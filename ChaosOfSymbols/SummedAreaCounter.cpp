@@ -0,0 +1,67 @@
+#include <algorithm>
+#include "SummedAreaCounter.h"
+
+/// <summary>
+/// Строит префиксные суммы по всем слотам за один проход по карте
+/// </summary>
+void SummedAreaCounter::Build(const TileGrid& map, const std::vector<NeighborCounts::Slot>& slotByTileId, int slotCount) {
+    m_width = map.GetWidth();
+    m_height = map.GetHeight();
+    m_slotCount = std::max(slotCount, 1);
+
+    size_t rowSize = static_cast<size_t>(m_width + 1) * m_slotCount;
+    m_table.assign(rowSize * (m_height + 1), 0);
+
+    m_rowSums.resize(m_slotCount);
+
+    map.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
+
+        for (int y = 0; y < m_height; y++) {
+            const std::uint32_t* above = m_table.data() + rowSize * y;
+            std::uint32_t* current = m_table.data() + rowSize * (y + 1);
+            std::fill(m_rowSums.begin(), m_rowSums.end(), 0u);
+
+            bool interiorRow = y > 0 && y < m_height - 1;
+            const Cell* row = map.Row<Cell>(y);
+
+            for (int x = 0; x < m_width; x++) {
+                if (interiorRow && x > 0 && x < m_width - 1) {
+                    NeighborCounts::Slot slot = slotByTileId[row[x]];
+                    if (slot < m_slotCount) {
+                        m_rowSums[slot]++;
+                    }
+                }
+
+                const std::uint32_t* up = above + static_cast<size_t>(x + 1) * m_slotCount;
+                std::uint32_t* out = current + static_cast<size_t>(x + 1) * m_slotCount;
+                for (int s = 0; s < m_slotCount; s++) {
+                    out[s] = up[s] + m_rowSums[s];
+                }
+            }
+        }
+    });
+}
+
+/// <summary>
+/// Заполняет counts для квадрата радиуса radius вокруг (x, y) без самой клетки
+/// </summary>
+void SummedAreaCounter::Count(int x, int y, int radius, NeighborCounts::Slot centerSlot, NeighborCounts& counts) const {
+    int x0 = std::max(x - radius, 0);
+    int y0 = std::max(y - radius, 0);
+    int x1 = std::min(x + radius, m_width - 1) + 1;
+    int y1 = std::min(y + radius, m_height - 1) + 1;
+
+    const std::uint32_t* a = Corner(x0, y0);
+    const std::uint32_t* b = Corner(x1, y0);
+    const std::uint32_t* c = Corner(x0, y1);
+    const std::uint32_t* d = Corner(x1, y1);
+
+    for (int s = 0; s < m_slotCount; s++) {
+        counts.counts[s] = static_cast<std::uint16_t>(d[s] - b[s] - c[s] + a[s]);
+    }
+
+    if (centerSlot < m_slotCount) {
+        counts.counts[centerSlot]--;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TileGrid.h"
+#include "NeighborCounts.h"
+
+/// <summary>
+/// Подсчет соседей в квадрате Мура любого радиуса за O(1) на клетку:
+/// одна таблица префиксных сумм (summed-area table) на слот тайла, строится раз за поколение.
+/// Граница карты (крайние строки и столбцы) в суммы не входит, как и в ядрах подсчета NeighborShape.
+/// </summary>
+class SummedAreaCounter {
+public:
+    // Конструктор
+    SummedAreaCounter() : m_width(0), m_height(0), m_slotCount(0) {}
+
+    // Публичные методы
+    void Build(const TileGrid& map, const std::vector<NeighborCounts::Slot>& slotByTileId, int slotCount);
+    void Count(int x, int y, int radius, NeighborCounts::Slot centerSlot, NeighborCounts& counts) const;
+
+    /// <summary>
+    /// Выгоден ли SAT для queryCount клеток карты width x height (с границей): (2R+1)^2-1 чтений на клетку
+    /// против 4 чтений на слот плюс построение таблиц по всей карте. Таблицы больше memoryLimitBytes не строятся
+    /// </summary>
+    static bool IsWorthwhile(int radius, int slotCount, long long queryCount, int width, int height, size_t memoryLimitBytes) {
+        if (radius <= 0 || GetTableBytes(width, height, slotCount) > memoryLimitBytes) return false;
+
+        long long cellCount = static_cast<long long>(width - 2) * (height - 2);
+        long long neighbors = (2LL * radius + 1) * (2LL * radius + 1) - 1;
+        return neighbors * queryCount > 4LL * slotCount * queryCount + 1LL * slotCount * cellCount;
+    }
+
+    static size_t GetTableBytes(int width, int height, int slotCount) {
+        return static_cast<size_t>(width + 1) * static_cast<size_t>(height + 1) *
+            static_cast<size_t>(std::max(slotCount, 1)) * sizeof(std::uint32_t);
+    }
+
+    // Геттеры
+    size_t GetMemoryBytes() const { return m_table.size() * sizeof(std::uint32_t); }
+
+private:
+    // Приватные методы
+    const std::uint32_t* Corner(int x, int y) const {
+        return m_table.data() + (static_cast<size_t>(y) * (m_width + 1) + x) * m_slotCount;
+    }
+
+    // Приватные поля
+    std::vector<std::uint32_t> m_table; // [(H+1) x (W+1) x слоты], слоты одной точки подряд
+    std::vector<std::uint32_t> m_rowSums;
+    int m_width;
+    int m_height;
+    int m_slotCount;
+};
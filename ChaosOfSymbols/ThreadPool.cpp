@@ -0,0 +1,107 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+    : m_task(nullptr), m_taskCount(0), m_nextTask(0),
+    m_activeWorkers(0), m_jobId(0), m_stopping(false) {
+    Resize(threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    StopWorkers();
+}
+
+/// <summary>
+/// 0 или меньше - по числу аппаратных потоков
+/// </summary>
+int ThreadPool::ResolveThreadCount(int requested) {
+    if (requested > 0) return requested;
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+/// <summary>
+/// Пересоздает рабочие потоки под новое количество (включая вызывающий поток)
+/// </summary>
+void ThreadPool::Resize(int threadCount) {
+    threadCount = std::max(threadCount, 1);
+    if (threadCount == GetThreadCount()) return;
+
+    StopWorkers();
+
+    m_stopping = false;
+    for (int i = 1; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, m_jobId);
+    }
+}
+
+/// <summary>
+/// Выполняет task(0..taskCount-1) на всех потоках и возвращается после завершения всех задач
+/// </summary>
+void ThreadPool::ParallelFor(int taskCount, const std::function<void(int)>& task) {
+    if (taskCount <= 0) return;
+
+    if (m_workers.empty() || taskCount == 1) {
+        for (int i = 0; i < taskCount; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_taskCount = taskCount;
+        m_nextTask.store(0);
+        m_activeWorkers = static_cast<int>(m_workers.size());
+        m_jobId++;
+    }
+    m_wakeWorkers.notify_all();
+
+    RunTasks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobDone.wait(lock, [this]() { return m_activeWorkers == 0; });
+    m_task = nullptr;
+}
+
+/// <summary>
+/// Забирает задачи, пока они не кончатся
+/// </summary>
+void ThreadPool::RunTasks() {
+    for (int index = m_nextTask.fetch_add(1); index < m_taskCount; index = m_nextTask.fetch_add(1)) {
+        (*m_task)(index);
+    }
+}
+
+void ThreadPool::WorkerLoop(unsigned long long seenJob) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeWorkers.wait(lock, [this, seenJob]() { return m_stopping || m_jobId != seenJob; });
+            if (m_stopping) return;
+            seenJob = m_jobId;
+        }
+
+        RunTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeWorkers--;
+        }
+        m_jobDone.notify_one();
+    }
+}
+
+void ThreadPool::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeWorkers.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Пул рабочих потоков для параллельных проходов по карте.
+/// ParallelFor раздает индексы задач потокам и ждет завершения всех; вызывающий поток тоже работает.
+/// </summary>
+class ThreadPool {
+public:
+    // Конструктор, деструктор
+    explicit ThreadPool(int threadCount = 1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Публичные методы
+    void Resize(int threadCount);
+    void ParallelFor(int taskCount, const std::function<void(int)>& task);
+
+    // Геттеры
+    int GetThreadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    // Статические методы
+    static int ResolveThreadCount(int requested);
+
+private:
+    // Приватные методы
+    void WorkerLoop(unsigned long long seenJob);
+    void RunTasks();
+    void StopWorkers();
+
+    // Приватные поля
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeWorkers;
+    std::condition_variable m_jobDone;
+    const std::function<void(int)>* m_task;
+    int m_taskCount;
+    std::atomic<int> m_nextTask;
+    int m_activeWorkers;
+    unsigned long long m_jobId;
+    bool m_stopping;
+};
@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Непрерывная сетка ID тайлов с шагом строки.
+/// Ширина ячейки (uint8/uint16) выбирается по максимальному ID тайла.
+/// Вокруг карты лежит ореол шириной halo, заполненный SentinelId: соседей можно читать без проверок границ
+/// </summary>
+class TileGrid {
+public:
+    using NarrowId = std::uint8_t;
+    using WideId = std::uint16_t;
+
+    // Конструктор
+    TileGrid() : m_width(0), m_height(0), m_stride(0), m_halo(0), m_origin(0), m_isWide(false) {}
+
+    // Публичные методы
+    void Resize(int width, int height, int maxTileId, int fillId = 0, int halo = 0) {
+        m_width = width;
+        m_height = height;
+        m_halo = std::max(0, halo);
+        m_isWide = maxTileId >= NarrowSentinelId;
+
+        // Слева ореол дополняется до RowAlignment, чтобы строки карты начинались выровненными
+        int leftPadding = (m_halo + RowAlignment - 1) / RowAlignment * RowAlignment;
+        m_stride = (leftPadding + width + m_halo + RowAlignment - 1) / RowAlignment * RowAlignment;
+        m_origin = static_cast<size_t>(m_halo) * m_stride + leftPadding;
+
+        size_t cells = static_cast<size_t>(m_stride) * static_cast<size_t>(m_height + 2 * m_halo);
+        if (m_isWide) {
+            m_narrowCells.clear();
+            m_narrowCells.shrink_to_fit();
+            m_wideCells.assign(cells, WideSentinelId);
+        }
+        else {
+            m_wideCells.clear();
+            m_wideCells.shrink_to_fit();
+            m_narrowCells.assign(cells, NarrowSentinelId);
+        }
+        Fill(fillId);
+    }
+
+    /// <summary>
+    /// Меняет ширину ореола с сохранением клеток карты
+    /// </summary>
+    void SetHalo(int halo) {
+        if (halo == m_halo) return;
+
+        TileGrid resized;
+        resized.Resize(m_width, m_height, m_isWide ? WideSentinelId : 0, 0, halo);
+        for (int y = 0; y < m_height; y++) {
+            for (int x = 0; x < m_width; x++) {
+                resized.Set(x, y, Get(x, y));
+            }
+        }
+        *this = std::move(resized);
+    }
+
+    /// <summary>
+    /// Расширяет ячейки до uint16, если новый максимальный ID не помещается в uint8
+    /// </summary>
+    void EnsureCapacity(int maxTileId) {
+        if (m_isWide || maxTileId < NarrowSentinelId) return;
+
+        m_wideCells.resize(m_narrowCells.size());
+        std::transform(m_narrowCells.begin(), m_narrowCells.end(), m_wideCells.begin(), [](NarrowId id) {
+            return id == NarrowSentinelId ? WideSentinelId : static_cast<WideId>(id);
+        });
+        m_narrowCells.clear();
+        m_narrowCells.shrink_to_fit();
+        m_isWide = true;
+    }
+
+    /// <summary>
+    /// Заполняет клетки карты; ореол сохраняет SentinelId
+    /// </summary>
+    void Fill(int tileId) {
+        for (int y = 0; y < m_height; y++) {
+            if (m_isWide) {
+                std::fill_n(Row<WideId>(y), m_width, static_cast<WideId>(tileId));
+            }
+            else {
+                std::fill_n(Row<NarrowId>(y), m_width, static_cast<NarrowId>(tileId));
+            }
+        }
+    }
+
+    /// <summary>
+    /// Вызывает func с тегом типа ячейки (NarrowId{} или WideId{}),
+    /// чтобы горячие циклы выбирали ширину один раз, а не на каждой клетке
+    /// </summary>
+    template <typename Func>
+    void Dispatch(Func&& func) const {
+        if (m_isWide) {
+            func(WideId{});
+        }
+        else {
+            func(NarrowId{});
+        }
+    }
+
+    // Геттеры
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetStride() const { return m_stride; }
+    int GetHalo() const { return m_halo; }
+    int GetSentinelId() const { return m_isWide ? WideSentinelId : NarrowSentinelId; }
+    bool IsWide() const { return m_isWide; }
+    bool InBounds(int x, int y) const { return x >= 0 && x < m_width && y >= 0 && y < m_height; }
+
+    /// <summary>
+    /// Клетка карты или ореола: -halo <= x < width + halo, -halo <= y < height + halo
+    /// </summary>
+    int Get(int x, int y) const {
+        size_t index = m_origin + static_cast<std::ptrdiff_t>(y) * m_stride + x;
+        return m_isWide ? m_wideCells[index] : m_narrowCells[index];
+    }
+
+    /// <summary>
+    /// Указатель на клетку x = 0 строки y; индексы от -halo до width + halo - 1 допустимы
+    /// </summary>
+    template <typename T>
+    const T* Row(int y) const {
+        return Cells<T>() + m_origin + static_cast<std::ptrdiff_t>(y) * m_stride;
+    }
+
+    template <typename T>
+    T* Row(int y) {
+        return const_cast<T*>(static_cast<const TileGrid*>(this)->Row<T>(y));
+    }
+
+    // Сеттеры
+    void Set(int x, int y, int tileId) {
+        size_t index = m_origin + static_cast<std::ptrdiff_t>(y) * m_stride + x;
+        if (m_isWide) {
+            m_wideCells[index] = static_cast<WideId>(tileId);
+        }
+        else {
+            m_narrowCells[index] = static_cast<NarrowId>(tileId);
+        }
+    }
+
+    // Константы
+    static constexpr int NarrowSentinelId = 0xFF;   // ореол: не тайл, соседом не считается
+    static constexpr int WideSentinelId = 0xFFFF;
+    static constexpr int MaxNarrowTileId = NarrowSentinelId - 1;
+    static constexpr int MaxWideTileId = WideSentinelId - 1;
+    static constexpr int RowAlignment = 16;
+
+private:
+    // Приватные методы
+    template <typename T>
+    const T* Cells() const {
+        if constexpr (sizeof(T) == sizeof(WideId)) {
+            return m_wideCells.data();
+        }
+        else {
+            return m_narrowCells.data();
+        }
+    }
+
+    // Приватные поля
+    std::vector<NarrowId> m_narrowCells;
+    std::vector<WideId> m_wideCells;
+    int m_width;
+    int m_height;
+    int m_stride;
+    int m_halo;
+    size_t m_origin; // смещение клетки (0, 0) с учетом ореола
+    bool m_isWide;
+};
@@ -0,0 +1,41 @@
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include "TilePalette.h"
+
+/// <summary>
+/// Таблицы по набору тайлов. Роль определяется по имени тайла (без учета регистра): "water", "grass", "mountain"
+/// </summary>
+void TilePalette::Build(const std::unordered_map<int, TileType>& tiles) {
+    static const char* const roleNames[RoleCount] = { "water", "grass", "mountain" };
+
+    m_idByChar.fill(NoTile);
+    m_idByRole.fill(NoTile);
+    m_maxTileId = 0;
+    for (const auto& pair : tiles) {
+        m_maxTileId = std::max(m_maxTileId, pair.first);
+    }
+    m_tileById.assign(m_maxTileId + 1, nullptr);
+    m_charById.assign(m_maxTileId + 1, UnknownCharacter);
+
+    for (const auto& pair : tiles) {
+        const TileType& tile = pair.second;
+        if (pair.first < 0) continue;
+
+        m_tileById[pair.first] = &tile;
+        m_charById[pair.first] = tile.GetCharacter();
+
+        int& idByChar = m_idByChar[static_cast<unsigned char>(tile.GetCharacter())];
+        if (idByChar == NoTile) {
+            idByChar = tile.GetId();
+        }
+
+        std::string name = tile.GetName();
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        for (int role = 0; role < RoleCount; role++) {
+            if (m_idByRole[role] == NoTile && name.find(roleNames[role]) != std::string::npos) {
+                m_idByRole[role] = tile.GetId();
+            }
+        }
+    }
+}
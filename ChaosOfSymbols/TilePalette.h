@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include "TileType.h"
+
+/// <summary>
+/// Роль тайла в генерации местности: по ней сглаживание находит воду, траву и горы
+/// </summary>
+enum class TerrainRole { Water, Grass, Mountain };
+
+/// <summary>
+/// Плотные таблицы текущего набора тайлов: символ -> ID, ID -> тайл и символ, роль местности -> ID.
+/// Перестраивается TileTypeManager при каждой загрузке тайлов, поиск - одно обращение к массиву.
+/// Если символ или роль есть у нескольких тайлов, берется первый в порядке обхода набора
+/// </summary>
+class TilePalette {
+public:
+    // Константы
+    static constexpr int NoTile = -1;
+    static constexpr char UnknownCharacter = '.'; // символ ID без тайла
+    static constexpr int RoleCount = 3;
+
+    // Конструктор
+    TilePalette() {
+        m_idByChar.fill(NoTile);
+        m_idByRole.fill(NoTile);
+    }
+
+    // Публичные методы
+    void Build(const std::unordered_map<int, TileType>& tiles);
+
+    // Геттеры
+    int GetTileId(char character) const { return m_idByChar[static_cast<unsigned char>(character)]; }
+    int GetRoleTileId(TerrainRole role) const { return m_idByRole[static_cast<int>(role)]; }
+    int GetMaxTileId() const { return m_maxTileId; }
+
+    const TileType* GetTile(int tileId) const {
+        return tileId >= 0 && tileId < static_cast<int>(m_tileById.size()) ? m_tileById[tileId] : nullptr;
+    }
+    char GetCharacter(int tileId) const {
+        return tileId >= 0 && tileId < static_cast<int>(m_charById.size()) ? m_charById[tileId] : UnknownCharacter;
+    }
+
+private:
+    // Приватные поля
+    std::array<int, 256> m_idByChar;
+    std::array<int, RoleCount> m_idByRole;
+    std::vector<const TileType*> m_tileById; // указатели в набор TileTypeManager, nullptr - свободный ID
+    std::vector<char> m_charById;
+    int m_maxTileId = 0;
+};
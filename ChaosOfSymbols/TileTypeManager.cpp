@@ -2,6 +2,7 @@
 #include <iostream>
 #include <sstream>
 #include <regex>
+#include <algorithm>
 #include "TileTypeManager.h"
 #include "Logger.h"
 
@@ -138,14 +139,16 @@ void TileTypeManager::LoadDefaultTiles() {
     Logger::Log("Loading default tile types...");
     m_tileTypes.clear();
 
-    RegisterTileType(TileType(0, "air", ' ', 0, true, false, 0));
-    RegisterTileType(TileType(1, "grass", '.', 10, true, false, 0));
-    RegisterTileType(TileType(2, "stone_wall", '#', 8, false, true, 0));
-    RegisterTileType(TileType(3, "water", '~', 9, false, false, 0));
-    RegisterTileType(TileType(4, "lava", '~', 4, true, false, 5));
-    RegisterTileType(TileType(5, "tree", 'T', 2, false, true, 0));
-    RegisterTileType(TileType(6, "sand", ',', 14, true, false, 0));
-    RegisterTileType(TileType(7, "mountain", '^', 7, false, false, 0));
+    AddTileType(TileType(0, "air", ' ', 0, true, false, 0));
+    AddTileType(TileType(1, "grass", '.', 10, true, false, 0));
+    AddTileType(TileType(2, "stone_wall", '#', 8, false, true, 0));
+    AddTileType(TileType(3, "water", '~', 9, false, false, 0));
+    AddTileType(TileType(4, "lava", '~', 4, true, false, 5));
+    AddTileType(TileType(5, "tree", 'T', 2, false, true, 0));
+    AddTileType(TileType(6, "sand", ',', 14, true, false, 0));
+    AddTileType(TileType(7, "mountain", '^', 7, false, false, 0));
+
+    m_palette.Build(m_tileTypes);
 
     Logger::Log("Loaded " + std::to_string(m_tileTypes.size()) + " default tile types");
 }
@@ -235,7 +238,7 @@ bool TileTypeManager::LoadFromFile(const std::string& filePath) {
             ", passable: " + (passable ? "true" : "false"));
 
         if (id >= 0 && !name.empty()) {
-            RegisterTileType(TileType(id, name, character, color, passable, destructible, damage));
+            AddTileType(TileType(id, name, character, color, passable, destructible, damage));
             Logger::Log("Successfully registered tile: " + name);
         }
         else {
@@ -243,6 +246,10 @@ bool TileTypeManager::LoadFromFile(const std::string& filePath) {
         }
     }
 
+    // Палитра строится один раз на весь файл; набор мог очиститься без единого корректного тайла -
+    // в палитре не должно остаться старых указателей
+    m_palette.Build(m_tileTypes);
+
     Logger::Log("\n=== TILE LOADING COMPLETED: " + std::to_string(m_tileTypes.size()) + " tiles loaded ===\n");
 
     Logger::Log("=== LOADED TILES SUMMARY ===\n");
@@ -309,9 +316,24 @@ TileType* TileTypeManager::GetTileType(int id) {
     return nullptr;
 }
 
+/// <summary>
+/// Возвращает наибольший ID среди загруженных тайлов (определяет ширину ячейки сетки мира)
+/// </summary>
+int TileTypeManager::GetMaxTileId() const {
+    return m_palette.GetMaxTileId();
+}
+
 /// <summary>
 /// Регистрация типов тайла
 /// </summary>
 void TileTypeManager::RegisterTileType(const TileType& tileType) {
+    AddTileType(tileType);
+    m_palette.Build(m_tileTypes);
+}
+
+/// <summary>
+/// Добавление тайла без перестройки палитры: загрузчики перестраивают ее один раз после всех тайлов
+/// </summary>
+void TileTypeManager::AddTileType(const TileType& tileType) {
     m_tileTypes[tileType.GetId()] = tileType;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <unordered_map>
 #include <string>
 #include "TileType.h"
+#include "TilePalette.h"
 
 class TileTypeManager {
 public:
@@ -15,11 +16,15 @@ public:
     // 
     const std::unordered_map<int, TileType>& GetAllTiles() const { return m_tileTypes; }
     TileType* GetTileType(int id);
+    const TilePalette& GetPalette() const { return m_palette; }
     size_t GetTileCount() const { return m_tileTypes.size(); }
+    int GetMaxTileId() const;
 
 private:
     void LoadDefaultTiles();
+    void AddTileType(const TileType& tileType);
 
     std::unordered_map<int, TileType> m_tileTypes;
+    TilePalette m_palette; //     m_tileTypes
     std::string m_resourceFilePath;
 };
\ No newline at end of file
@@ -1,22 +1,159 @@
 #include <random>
 #include <algorithm>
 #include <ctime>
+#include <chrono>
+#include <cmath>
 #include "World.h"
 #include "Logger.h"
 
+namespace {
+    int PopCount(std::uint64_t bits) {
+        bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+        bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+        bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<int>((bits * 0x0101010101010101ULL) >> 56);
+    }
+
+    int LowestBit(std::uint64_t bits) {
+        return PopCount((bits & (~bits + 1)) - 1);
+    }
+
+    /// <summary>
+    /// Перемешивание 64-битного значения (финализатор SplitMix64)
+    /// </summary>
+    std::uint64_t MixHash(std::uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    /// <summary>
+    /// Случайное число клетки (x, y) в поколении generation для потока stream (по правилу клетки).
+    /// Счетчиковый генератор: число зависит только от аргументов, а не от порядка обхода клеток,
+    /// числа потоков или разбиения поколения на части, и общего состояния у потоков нет
+    /// </summary>
+    std::uint64_t CellRandom(std::uint64_t key, long long generation, int x, int y, int stream) {
+        std::uint64_t cell = static_cast<std::uint64_t>(static_cast<std::uint32_t>(y)) << 32 | static_cast<std::uint32_t>(x);
+        std::uint64_t value = MixHash(key + static_cast<std::uint64_t>(generation) * 0x9E3779B97F4A7C15ULL);
+        value = MixHash(value ^ cell);
+        return MixHash(value + static_cast<std::uint64_t>(stream) * 0xD1B54A32D192ED03ULL);
+    }
+
+    int BitWidth(int value) {
+        int bits = 0;
+        while ((1 << bits) <= value) bits++;
+        return bits;
+    }
+
+    /// <summary>
+    /// Слово строки плоскости, сдвинутое так, что бит клетки x содержит бит клетки x + dx (|dx| < 64)
+    /// </summary>
+    std::uint64_t ShiftedWord(const std::uint64_t* row, int words, int word, int dx) {
+        if (dx > 0) {
+            std::uint64_t result = row[word] >> dx;
+            if (word + 1 < words) result |= row[word + 1] << (64 - dx);
+            return result;
+        }
+        if (dx < 0) {
+            std::uint64_t result = row[word] << -dx;
+            if (word > 0) result |= row[word - 1] >> (64 + dx);
+            return result;
+        }
+        return row[word];
+    }
+
+    // Бит-срезовая арифметика: разряд b числа для 64 клеток хранится в слове value[b]
+    void AddBit(std::uint64_t* acc, int bits, std::uint64_t carry) {
+        for (int b = 0; b < bits && carry; b++) {
+            std::uint64_t nextCarry = acc[b] & carry;
+            acc[b] ^= carry;
+            carry = nextCarry;
+        }
+    }
+
+    void SubtractBit(std::uint64_t* acc, int bits, std::uint64_t borrow) {
+        for (int b = 0; b < bits && borrow; b++) {
+            std::uint64_t nextBorrow = ~acc[b] & borrow;
+            acc[b] ^= borrow;
+            borrow = nextBorrow;
+        }
+    }
+
+    void AddSliced(std::uint64_t* acc, int bits, const std::uint64_t* value, int valueBits, size_t valueStride) {
+        std::uint64_t carry = 0;
+        for (int b = 0; b < bits; b++) {
+            std::uint64_t digit = b < valueBits ? value[b * valueStride] : 0;
+            std::uint64_t sum = acc[b] ^ digit;
+            std::uint64_t nextCarry = (acc[b] & digit) | (carry & sum);
+            acc[b] = sum ^ carry;
+            carry = nextCarry;
+        }
+    }
+
+    /// <summary>
+    /// Маски value < constant и value == constant для бит-срезового числа
+    /// </summary>
+    void CompareSliced(const std::uint64_t* value, int bits, int constant, std::uint64_t& less, std::uint64_t& equal) {
+        if (constant < 0) {
+            less = 0;
+            equal = 0;
+            return;
+        }
+        if (constant >= (1 << bits)) {
+            less = ~0ULL;
+            equal = 0;
+            return;
+        }
+
+        less = 0;
+        equal = ~0ULL;
+        for (int b = bits - 1; b >= 0; b--) {
+            if ((constant >> b) & 1) {
+                less |= equal & ~value[b];
+                equal &= value[b];
+            }
+            else {
+                equal &= ~value[b];
+            }
+        }
+    }
+}
+
 World::World()
     : m_width(0), m_height(0), m_contentWidth(0), m_contentHeight(0),
     m_automatonEnabled(true), m_tileManager(nullptr), m_foodManager(nullptr),
-    m_automatonConfig(nullptr) 
+    m_automatonConfig(nullptr), m_borderTileId(0), m_slotCount(0), m_countedSlotCount(0),
+    m_ruleSlotCount(0), m_smoothingPass(false), m_smoothingSlotCount(0),
+    m_rulesBindingDirty(true), m_boundRulesRevision(-1), m_useOutcomeTable(false),
+    m_useBitplaneKernel(false), m_wordsPerRow(0), m_countBits(0), m_rowSumBits(0), m_ruleRandomKey(0), m_useAreaCounts(false),
+    m_activeCellCount(0), m_automatonFullUpdate(true), m_detailRadius(0), m_detailFocusX(0), m_detailFocusY(0),
+    m_detailCenterX(0), m_detailCenterY(0), m_gridHash(0), m_cyclePeriod(0),
+    m_cycleConfirmed(false), m_cyclePosition(0), m_skippedGenerations(0), m_generation(0),
+    m_nextPooledSnapshot(0), m_pendingGenerations(0), m_stopWorker(false), m_frameBudgetMs(0), m_chunkedGenerationActive(false),
+    m_chunkedFullUpdate(false), m_chunkedPhase(ChunkedPhase::Commit), m_chunkedNextRow(0), m_chunkedFrames(0),
+    m_chunkedStepMs(0.0)
 {
+    m_slotByChar.fill(NeighborCounts::NoSlot);
+}
+
+World::~World() {
+    StopAutomatonWorker();
 }
 
 /// <summary>
 /// Генерация мира согласно конфигу
 /// </summary>
 void World::GenerateFromConfig() {
+    std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
     Logger::Log("\n=== STARTING PURE RULE-BASED GENERATION ===\n");
 
+    // Запросы поколений и недосчитанное поколение относятся к старой карте
+    AbandonChunkedGeneration();
+    {
+        std::lock_guard<std::mutex> requestLock(m_requestMutex);
+        m_pendingGenerations = 0;
+    }
+
     if (!m_config.LoadConfig()) {
         Logger::Log("ERROR: Failed to load world generation config");
         return;
@@ -27,15 +164,27 @@ void World::GenerateFromConfig() {
     m_width = m_contentWidth + 2;
     m_height = m_contentHeight + 2;
 
-    m_map.resize(m_height, std::vector<int>(m_width, 0));
+    int maxTileId = m_tileManager ? m_tileManager->GetMaxTileId() : 0;
+    m_neighborShape = m_config.GetNeighborShape();
+    // Ореол шириной в радиус окрестности: окрестность любой клетки карты читается без проверок границ
+    m_map.Resize(m_width, m_height, maxTileId, 0, m_neighborShape.GetRadius());
+    RebuildTileSlots();
+    m_threadPool.Resize(ThreadPool::ResolveThreadCount(m_config.GetAutomatonThreads()));
+    m_frameBudgetMs = m_config.GetAutomatonFrameBudgetMs();
+    SetupDetailLevels();
 
     int currentSeed = m_config.GetEffectiveSeed();
     m_noiseGenerator.SetSeed(currentSeed);
+    m_ruleRandomKey = MixHash(static_cast<std::uint64_t>(static_cast<std::uint32_t>(currentSeed)));
     m_noiseGenerator.SetFrequency(m_config.GetNoiseFrequency());
 
     Logger::Log("Content size: " + std::to_string(m_contentWidth) + "x" + std::to_string(m_contentHeight));
     Logger::Log("Total size with border: " + std::to_string(m_width) + "x" + std::to_string(m_height));
     Logger::Log("Using seed: " + std::to_string(currentSeed));
+    Logger::Log("Neighborhood: " + m_neighborShape.GetDescription());
+    if (m_frameBudgetMs > 0) {
+        Logger::Log("Automaton generations: row chunks within " + std::to_string(m_frameBudgetMs) + " ms per frame");
+    }
 
     if (m_automatonConfig) {
         Logger::Log("Cellular automaton config is available (external)");
@@ -48,7 +197,13 @@ void World::GenerateFromConfig() {
 
     CreateBorder();
 
+    // Второй буфер поколения получает ту же границу; дальше шаги только меняют буферы местами
+    m_nextMap = m_map;
+
     SmoothTerrain();
+    m_automatonFullUpdate = true;
+    m_generation = 0;
+    PublishSnapshot();
 
     if (m_foodManager) {
         int initialFoodCount = (m_contentWidth * m_contentHeight) / 10;
@@ -62,6 +217,40 @@ void World::GenerateFromConfig() {
     Logger::Log("=== RULE-BASED GENERATION COMPLETED ===");
 }
 
+/// <summary>
+/// Новые правила спавна (world_spawn.cfg): тайлы заново выбираются по сохраненным полям генерации,
+/// шум не пересчитывается. Карта заменяется, как при генерации, еда остается на месте
+/// </summary>
+void World::ReloadSpawnRules() {
+    std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
+
+    if (!m_config.ReloadSpawnConfig()) {
+        Logger::Log("ERROR: Failed to reload spawn config");
+        return;
+    }
+    if (!HasTerrainLayers()) {
+        Logger::Log("Spawn rules reloaded, they apply on the next generation");
+        return;
+    }
+
+    AbandonChunkedGeneration();
+    {
+        std::lock_guard<std::mutex> requestLock(m_requestMutex);
+        m_pendingGenerations = 0;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    GenerateBaseTerrain();
+    m_nextMap = m_map;
+    SmoothTerrain();
+    m_automatonFullUpdate = true;
+    m_generation = 0;
+    PublishSnapshot();
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    Logger::Log("Spawn rules applied to the cached zone layer in " + std::to_string(elapsedMs) + " ms");
+}
+
 /// <summary>
 /// Генерация баззового пространства с шумом Перлина и правил спавна
 /// </summary>
@@ -71,61 +260,169 @@ void World::GenerateBaseTerrain() {
         return;
     }
 
-    const auto& spawnRules = m_config.GetAllSpawnRules();
-
-    if (spawnRules.empty()) {
+    if (m_config.GetAllSpawnRules().empty()) {
         Logger::Log("WARNING: No spawn rules found");
         return;
     }
 
-    char waterChar = FindWaterTile(spawnRules);
-    char grassChar = FindGrassTile(spawnRules);
-    char mountainChar = FindMountainTile(spawnRules);
+    // Поля шума зависят только от сида, частоты и размера: при той же генерации считается один выбор тайлов
+    if (HasTerrainLayers()) {
+        Logger::Log("Reusing height and zone layers for seed " + std::to_string(m_terrainLayers.seed));
+    }
+    else {
+        BuildTerrainLayers();
+    }
 
-    int tilesPlaced = 0;
-    std::unordered_map<char, int> tileStatistics;
+    BuildZoneTileTables();
+    ApplyZoneTiles();
+}
 
-    for (int y = 1; y < m_height - 1; y++) {
-        for (int x = 1; x < m_width - 1; x++) {
-            float baseNoise = (m_noiseGenerator.GetNoise((float)x * 0.03f, (float)y * 0.03f) + 1.0f) * 0.5f;
-            float ridgeNoise = 1.0f - std::abs(m_noiseGenerator.GetNoise((float)x * 0.06f + 1000, (float)y * 0.06f + 1000));
-            float detailNoise = (m_noiseGenerator.GetNoise((float)x * 0.15f + 2000, (float)y * 0.15f + 2000) + 1.0f) * 0.5f;
+/// <summary>
+/// Совпадают ли сохраненные поля генерации с текущими сидом, частотой шума и размером карты
+/// </summary>
+bool World::HasTerrainLayers() const {
+    return m_terrainLayers.columns == m_width - 2 && m_terrainLayers.rows == m_height - 2 &&
+        m_terrainLayers.seed == m_config.GetEffectiveSeed() && m_terrainLayers.frequency == m_config.GetNoiseFrequency() &&
+        !m_terrainLayers.zones.empty();
+}
 
-            float heightNoise = baseNoise * 0.4f + ridgeNoise * 0.4f + detailNoise * 0.2f;
+/// <summary>
+/// Поля генерации: высота из трех слоев шума, зона высот и шум выбора тайла для каждой клетки
+/// </summary>
+void World::BuildTerrainLayers() {
+    int columns = m_width - 2;
+    int rows = m_height - 2;
+    size_t cellCount = static_cast<size_t>(columns) * rows;
+
+    m_terrainLayers.columns = columns;
+    m_terrainLayers.rows = rows;
+    m_terrainLayers.seed = m_config.GetEffectiveSeed();
+    m_terrainLayers.frequency = m_config.GetNoiseFrequency();
+    m_terrainLayers.heights.resize(cellCount);
+    m_terrainLayers.zones.resize(cellCount);
+    m_terrainLayers.selectionNoise.resize(cellCount);
+
+    // Слои шума (основа, хребты, детали, разброс вероятностей тайлов) лежат в одном пакете на строку:
+    // GetNoiseBatch выбирает тип шума один раз на всю строку всех слоев
+    struct NoiseLayer {
+        float scale;
+        float offset;
+    };
+    const NoiseLayer layers[] = { { 0.03f, 0.0f }, { 0.06f, 1000.0f }, { 0.15f, 2000.0f }, { 0.1f, 0.0f } };
+    const int layerCount = static_cast<int>(sizeof(layers) / sizeof(layers[0]));
+
+    std::vector<float> layerX(static_cast<size_t>(layerCount) * columns);
+    for (int layer = 0; layer < layerCount; layer++) {
+        for (int x = 1; x < m_width - 1; x++) {
+            layerX[static_cast<size_t>(layer) * columns + x - 1] = (float)x * layers[layer].scale + layers[layer].offset;
+        }
+    }
 
-            heightNoise = std::pow(heightNoise, 1.1f); // Меньше эрозии
+    // Клетки независимы, а GetNoise не меняет генератор: полосы строк считаются параллельно
+    ForEachRowBand(1, m_height - 1, [&](int, int firstRow, int lastRow) {
+        std::vector<float> layerY(layerX.size());
+        std::vector<float> noise(layerX.size());
 
-            int zone;
-            if (heightNoise < 0.25f) {  // 25%
-                zone = 0; // Низкая зона
+        for (int y = firstRow; y < lastRow; y++) {
+            for (int layer = 0; layer < layerCount; layer++) {
+                float layerRowY = (float)y * layers[layer].scale + layers[layer].offset;
+                std::fill_n(layerY.begin() + static_cast<size_t>(layer) * columns, columns, layerRowY);
             }
-            else if (heightNoise < 0.7f) { // 45% 
-                zone = 1; // Средняя зона
-            }
-            else { // 30%
-                zone = 2; // Высокая зона
+            m_noiseGenerator.GetNoiseBatch(layerX.data(), layerY.data(), static_cast<int>(layerX.size()), noise.data());
+
+            const float* baseRow = noise.data();
+            const float* ridgeRow = baseRow + columns;
+            const float* detailRow = ridgeRow + columns;
+            const float* variationRow = detailRow + columns;
+            size_t rowOffset = static_cast<size_t>(y - 1) * columns;
+
+            for (int x = 1; x < m_width - 1; x++) {
+                float baseNoise = (baseRow[x - 1] + 1.0f) * 0.5f;
+                float ridgeNoise = 1.0f - std::abs(ridgeRow[x - 1]);
+                float detailNoise = (detailRow[x - 1] + 1.0f) * 0.5f;
+
+                float heightNoise = baseNoise * 0.4f + ridgeNoise * 0.4f + detailNoise * 0.2f;
+
+                heightNoise = std::pow(heightNoise, 1.1f); // Меньше эрозии
+
+                std::uint8_t zone;
+                if (heightNoise < 0.25f) {  // 25%
+                    zone = 0; // Низкая зона
+                }
+                else if (heightNoise < 0.7f) { // 45% 
+                    zone = 1; // Средняя зона
+                }
+                else { // 30%
+                    zone = 2; // Высокая зона
+                }
+
+                m_terrainLayers.heights[rowOffset + x - 1] = heightNoise;
+                m_terrainLayers.zones[rowOffset + x - 1] = zone;
+                m_terrainLayers.selectionNoise[rowOffset + x - 1] = (variationRow[x - 1] + 1.0f) * 0.5f;
             }
+        }
+    });
 
-            // Выбираем тайл на основе зоны
-            char selectedTile = SelectTileByZone(zone, spawnRules, x, y);
-            int selectedTileId = FindTileIdByCharacter(selectedTile);
+    Logger::Log("Height and zone layers generated for seed " + std::to_string(m_terrainLayers.seed));
+}
 
-            if (selectedTileId != -1) {
-                m_map[y][x] = selectedTileId;
-                tilesPlaced++;
-                tileStatistics[selectedTile]++;
+/// <summary>
+/// Выбор тайлов по зонам из сохраненных полей генерации: без шума, только таблицы спавна
+/// </summary>
+void World::ApplyZoneTiles() {
+    int columns = m_terrainLayers.columns;
+
+    // У каждой полосы своя статистика по ID тайла, которая складывается в конце
+    struct BandStatistics {
+        int tilesPlaced = 0;
+        std::vector<int> tiles;
+    };
+    std::vector<BandStatistics> bandStatistics(GetRowBandCount(m_height - 2));
+    int maxTileId = m_tileManager->GetMaxTileId();
+
+    ForEachRowBand(1, m_height - 1, [&](int band, int firstRow, int lastRow) {
+        BandStatistics& statistics = bandStatistics[band];
+        statistics.tiles.assign(maxTileId + 1, 0);
+
+        for (int y = firstRow; y < lastRow; y++) {
+            size_t rowOffset = static_cast<size_t>(y - 1) * columns;
+            const std::uint8_t* zoneRow = m_terrainLayers.zones.data() + rowOffset;
+            const float* noiseRow = m_terrainLayers.selectionNoise.data() + rowOffset;
+
+            for (int x = 1; x < m_width - 1; x++) {
+                // Выбираем тайл на основе зоны
+                int selectedTileId = SelectTileByZone(zoneRow[x - 1], noiseRow[x - 1]);
+
+                if (selectedTileId != -1) {
+                    m_map.Set(x, y, selectedTileId);
+                    statistics.tilesPlaced++;
+                    statistics.tiles[selectedTileId]++;
+                }
+                else {
+                    // Как после Resize при генерации: при перезагрузке правил спавна в клетке еще старый тайл
+                    m_map.Set(x, y, 0);
+                }
             }
         }
+    });
+
+    int tilesPlaced = 0;
+    std::vector<int> tileStatistics(maxTileId + 1, 0);
+    for (const BandStatistics& statistics : bandStatistics) {
+        tilesPlaced += statistics.tilesPlaced;
+        for (int tileId = 0; tileId <= maxTileId; tileId++) {
+            tileStatistics[tileId] += statistics.tiles[tileId];
+        }
     }
 
     Logger::Log("Zone-based terrain generated: " + std::to_string(tilesPlaced) + " tiles placed");
-    for (const auto& stat : tileStatistics) {
-        std::string tileName = "unknown";
-        TileType* tile = m_tileManager->GetTileType(FindTileIdByCharacter(stat.first));
-        if (tile) {
-            tileName = tile->GetName();
-        }
-        Logger::Log("  '" + std::string(1, stat.first) + "' (" + tileName + "): " + std::to_string(stat.second));
+    for (int tileId = 0; tileId <= maxTileId; tileId++) {
+        if (tileStatistics[tileId] == 0) continue;
+
+        const TileType* tile = m_tileManager->GetPalette().GetTile(tileId);
+        std::string tileName = tile ? tile->GetName() : "unknown";
+        Logger::Log("  '" + std::string(1, GetTileCharacter(tileId)) + "' (" + tileName + "): " +
+            std::to_string(tileStatistics[tileId]));
     }
 }
 
@@ -144,109 +441,150 @@ void World::SmoothTerrain() {
     char grassChar = FindGrassTile(spawnRules);
     char mountainChar = FindMountainTile(spawnRules);
 
-    std::vector<std::vector<int>> newMap = m_map;
+    int waterId = FindTileIdByCharacter(waterChar);
+    int grassId = FindTileIdByCharacter(grassChar);
+    int mountainId = FindTileIdByCharacter(mountainChar);
+
+    // Правила сглаживания читают только воду, траву и горы - счетчики и префиксные суммы только по ним
+    NeighborCounts::Slot slots[] = { GetCharacterSlot(waterChar), GetCharacterSlot(grassChar), GetCharacterSlot(mountainChar) };
+    BuildSmoothingSlots(slots, 3);
+    NeighborCounts::Slot waterSlot = slots[0];
+    NeighborCounts::Slot grassSlot = slots[1];
+    NeighborCounts::Slot mountainSlot = slots[2];
+
+    NeighborCounts neighbors;
     int changes = 0;
 
-    for (int y = 1; y < m_height - 1; y++) {
-        for (int x = 1; x < m_width - 1; x++) {
-            auto neighbors = CountNeighbors(x, y, m_map);
-            char current = GetTileCharacter(m_map[y][x]);
+    PrepareNeighborCounting(m_map, static_cast<long long>(m_width - 2) * (m_height - 2), true);
 
-            int waterCount = neighbors.count(waterChar) ? neighbors.at(waterChar) : 0;
-            int mountainCount = neighbors.count(mountainChar) ? neighbors.at(mountainChar) : 0;
-            int grassCount = neighbors.count(grassChar) ? neighbors.at(grassChar) : 0;
+    m_map.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
 
-            if (current == mountainChar) {
-                if (waterCount >= 4) {
-                    newMap[y][x] = FindTileIdByCharacter(waterChar); // Горы у воды -> вода
-                    changes++;
-                }
-                else if (waterCount >= 3 && grassCount <= 2) {
-                    newMap[y][x] = FindTileIdByCharacter(waterChar); // Горы рядом с водой -> вода
-                    changes++;
-                }
-            }
-            else if (current == waterChar) {
-                if (mountainCount >= 5) {
-                    newMap[y][x] = FindTileIdByCharacter(mountainChar); // Вода в горах -> горы
-                    changes++;
-                }
-                else if (grassCount >= 6 && mountainCount <= 1) {
-                    newMap[y][x] = FindTileIdByCharacter(grassChar); // Мелководье -> трава
-                    changes++;
-                }
-            }
-            else if (current == grassChar) {
-                if (waterCount >= 5) {
-                    newMap[y][x] = FindTileIdByCharacter(waterChar); // Заболоченная трава -> вода
-                    changes++;
-                }
-                else if (mountainCount >= 4 && waterCount <= 1) {
-                    newMap[y][x] = FindTileIdByCharacter(mountainChar); // Предгорье -> горы
-                    changes++;
+        DispatchNeighborCounter<Cell>(m_map, [&](const auto& countNeighbors) {
+            for (int y = 1; y < m_height - 1; y++) {
+                const Cell* row = m_map.Row<Cell>(y);
+                Cell* newRow = m_nextMap.Row<Cell>(y);
+
+                for (int x = 1; x < m_width - 1; x++) {
+                    countNeighbors(x, y, neighbors);
+                    char current = GetTileCharacter(row[x]);
+                    newRow[x] = row[x];
+
+                    int waterCount = neighbors.Get(waterSlot);
+                    int mountainCount = neighbors.Get(mountainSlot);
+                    int grassCount = neighbors.Get(grassSlot);
+
+                    if (current == mountainChar) {
+                        if (waterCount >= 4) {
+                            newRow[x] = static_cast<Cell>(waterId); // Горы у воды -> вода
+                            changes++;
+                        }
+                        else if (waterCount >= 3 && grassCount <= 2) {
+                            newRow[x] = static_cast<Cell>(waterId); // Горы рядом с водой -> вода
+                            changes++;
+                        }
+                    }
+                    else if (current == waterChar) {
+                        if (mountainCount >= 5) {
+                            newRow[x] = static_cast<Cell>(mountainId); // Вода в горах -> горы
+                            changes++;
+                        }
+                        else if (grassCount >= 6 && mountainCount <= 1) {
+                            newRow[x] = static_cast<Cell>(grassId); // Мелководье -> трава
+                            changes++;
+                        }
+                    }
+                    else if (current == grassChar) {
+                        if (waterCount >= 5) {
+                            newRow[x] = static_cast<Cell>(waterId); // Заболоченная трава -> вода
+                            changes++;
+                        }
+                        else if (mountainCount >= 4 && waterCount <= 1) {
+                            newRow[x] = static_cast<Cell>(mountainId); // Предгорье -> горы
+                            changes++;
+                        }
+                    }
                 }
             }
-        }
-    }
+        });
+    });
 
     if (changes > 0) {
-        m_map = newMap;
+        std::swap(m_map, m_nextMap);
         Logger::Log("Natural smoothing applied: " + std::to_string(changes) + " changes made");
     }
 }
 
 /// <summary>
-/// Выбирает тайл для зоны на основе вероятностей из спавн-правил
+/// Переводит таблицы зон из конфига в ID тайлов: выбор тайла для клетки обходится без поиска по символу
 /// </summary>
-/// <param name="zone">0=низины(вода), 1=равнины(трава), 2=горы</param>
-/// <param name="spawnRules">правила спавна для разных типов terrain</param>
-/// <returns>символ выбранного тайла</returns>
-char World::SelectTileByZone(int zone, const std::unordered_map<char, SpawnRule>& spawnRules, int x, int y) {
-    float noise = (m_noiseGenerator.GetNoise((float)x * 0.1f, (float)y * 0.1f) + 1.0f) * 0.5f;
+void World::BuildZoneTileTables() {
+    const std::vector<SpawnZoneTable>& spawnTables = m_config.GetSpawnZoneTables();
+    m_zoneTileTables.assign(spawnTables.size(), ZoneTileTable());
 
-    // Создаем взвешенный выбор на основе вероятностей
-    std::vector<std::pair<char, float>> weightedTiles;
-    float totalWeight = 0.0f;
+    for (size_t zone = 0; zone < spawnTables.size(); zone++) {
+        const SpawnZoneTable& spawnTable = spawnTables[zone];
+        ZoneTileTable& table = m_zoneTileTables[zone];
 
-    for (const auto& pair : spawnRules) {
-        char tileChar = pair.first;
-        const SpawnRule& rule = pair.second;
+        for (char tile : spawnTable.tiles) {
+            table.tileIds.push_back(FindTileIdByCharacter(tile));
+        }
+        table.cumulative = spawnTable.cumulative;
+        table.totalWeight = spawnTable.GetTotalWeight();
+        table.fallbackTileId = FindTileIdByCharacter(spawnTable.tiles.empty() ? '.' : spawnTable.fallbackTile);
 
-        if (rule.zoneProbabilities.size() > zone) {
-            float baseProb = rule.zoneProbabilities[zone];
-            // Добавляем небольшую вариативность на основе шума
-            float variedProb = baseProb * (0.9f + noise * 0.2f);
-            weightedTiles.push_back({ tileChar, variedProb });
-            totalWeight += variedProb;
+        if (spawnTable.tiles.empty()) {
+            Logger::Log("No tiles available for zone " + std::to_string(zone) + ", using '.'");
         }
     }
+}
 
-    if (totalWeight > 0.0f) {
-        float randomValue = noise * totalWeight;
-        float currentWeight = 0.0f;
-
-        for (const auto& weightedTile : weightedTiles) {
-            currentWeight += weightedTile.second;
-            if (randomValue <= currentWeight) {
-                return weightedTile.first;
-            }
-        }
+/// <summary>
+/// Выбирает тайл для зоны на основе вероятностей из спавн-правил
+/// </summary>
+/// <param name="zone">0=низины(вода), 1=равнины(трава), 2=горы</param>
+/// <param name="noise">шум клетки в [0, 1]: разброс вероятностей и выбор тайла</param>
+/// <returns>ID выбранного тайла или -1</returns>
+int World::SelectTileByZone(int zone, float noise) const {
+    if (zone < 0 || zone >= static_cast<int>(m_zoneTileTables.size())) {
+        return FindTileIdByCharacter('.');
     }
 
-    if (!weightedTiles.empty()) {
-        std::sort(weightedTiles.begin(), weightedTiles.end(),
-            [](const auto& a, const auto& b) { return a.second > b.second; });
-        return weightedTiles[0].first;
+    const ZoneTileTable& table = m_zoneTileTables[zone];
+    if (table.totalWeight <= 0.0f) {
+        return table.fallbackTileId;
     }
 
-    Logger::Log("No tiles available for zone " + std::to_string(zone) + ", using '.'");
-    return '.';
+    // Небольшая вариативность на основе шума: все веса зоны умножаются на один множитель
+    float scale = 0.9f + noise * 0.2f;
+    float randomValue = noise * (table.totalWeight * scale);
+
+    for (size_t i = 0; i < table.cumulative.size(); i++) {
+        if (randomValue <= table.cumulative[i] * scale) {
+            return table.tileIds[i];
+        }
+    }
+    return table.fallbackTileId;
 }
 
 /// <summary>
 /// Создание непроходимой границы по краям карты
 /// </summary>
 void World::CreateBorder() {
+    // Кольцо границы, как и ореол, хранит SentinelId: автомат его не считает соседом и не меняет.
+    // Тайл границы для отображения запоминается отдельно (см. GetTileAtFullMap)
+    int sentinelId = m_map.GetSentinelId();
+    for (int x = 0; x < m_width; x++) {
+        m_map.Set(x, 0, sentinelId);
+        m_map.Set(x, m_height - 1, sentinelId);
+    }
+
+    for (int y = 0; y < m_height; y++) {
+        m_map.Set(0, y, sentinelId);
+        m_map.Set(m_width - 1, y, sentinelId);
+    }
+
+    m_borderTileId = 0;
     if (!m_tileManager) {
         Logger::Log("ERROR: No tile manager for border creation");
         return;
@@ -259,16 +597,7 @@ void World::CreateBorder() {
     }
 
     Logger::Log("Creating border with tile ID: " + std::to_string(borderTileId));
-
-    for (int x = 0; x < m_width; x++) {
-        m_map[0][x] = borderTileId;
-        m_map[m_height - 1][x] = borderTileId;
-    }
-
-    for (int y = 0; y < m_height; y++) {
-        m_map[y][0] = borderTileId;
-        m_map[y][m_width - 1] = borderTileId;
-    }
+    m_borderTileId = borderTileId;
 
     Logger::Log("Border created successfully");
 }
@@ -277,40 +606,34 @@ void World::CreateBorder() {
 /// Находит символ тайла воды
 /// </summary>
 char World::FindWaterTile(const std::unordered_map<char, SpawnRule>& spawnRules) const {
-    return FindTileByTerrainType("water", spawnRules);
+    return FindTileByTerrainType(TerrainRole::Water, spawnRules);
 }
 
 /// <summary>
 /// Находит символ тайла травы
 /// </summary>
 char World::FindGrassTile(const std::unordered_map<char, SpawnRule>& spawnRules) const {
-    return FindTileByTerrainType("grass", spawnRules);
+    return FindTileByTerrainType(TerrainRole::Grass, spawnRules);
 }
 
 /// <summary>
 /// Находит символ тайла гор
 /// </summary>
 char World::FindMountainTile(const std::unordered_map<char, SpawnRule>& spawnRules) const {
-    return FindTileByTerrainType("mountain", spawnRules);
+    return FindTileByTerrainType(TerrainRole::Mountain, spawnRules);
 }
 
 /// <summary>
-/// Универсальный метод поиска тайла по типу terrain (water/grass/mountain)
+/// Универсальный метод поиска тайла по типу terrain (water/grass/mountain): сначала роль из палитры тайлов,
+/// затем тайл, который правила спавна чаще всего ставят в зону этой роли
 /// </summary>
-char World::FindTileByTerrainType(const std::string& terrainType, const std::unordered_map<char, SpawnRule>& spawnRules) const {
+char World::FindTileByTerrainType(TerrainRole role, const std::unordered_map<char, SpawnRule>& spawnRules) const {
     if (!m_tileManager) return '?';
 
-    Logger::Log("Looking for terrain type: " + terrainType);
-
-    const auto& allTiles = m_tileManager->GetAllTiles();
-    for (const auto& pair : allTiles) {
-        const TileType& tile = pair.second;
-        std::string name = tile.GetName();
-        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-
-        if (name.find(terrainType) != std::string::npos) {
-            return tile.GetCharacter();
-        }
+    const TilePalette& palette = m_tileManager->GetPalette();
+    int roleTileId = palette.GetRoleTileId(role);
+    if (roleTileId != TilePalette::NoTile) {
+        return palette.GetCharacter(roleTileId);
     }
 
     for (const auto& spawnPair : spawnRules) {
@@ -322,13 +645,13 @@ char World::FindTileByTerrainType(const std::string& terrainType, const std::uno
             float midProb = rule.zoneProbabilities[1];
             float highProb = rule.zoneProbabilities[2];
 
-            if (terrainType == "water" && lowProb > midProb && lowProb > highProb) {
+            if (role == TerrainRole::Water && lowProb > midProb && lowProb > highProb) {
                 return character;
             }
-            else if (terrainType == "grass" && midProb > lowProb && midProb > highProb) {
+            else if (role == TerrainRole::Grass && midProb > lowProb && midProb > highProb) {
                 return character;
             }
-            else if (terrainType == "mountain" && highProb > lowProb && highProb > midProb) {
+            else if (role == TerrainRole::Mountain && highProb > lowProb && highProb > midProb) {
                 return character;
             }
         }
@@ -342,220 +665,1684 @@ char World::FindTileByTerrainType(const std::string& terrainType, const std::uno
 /// Применение правил клеточного автомата для изменения мира
 /// </summary>
 void World::UpdateCellularAutomaton() {
-    if (!m_automatonEnabled || !m_tileManager || !m_automatonConfig) {
-        Logger::Log("Cellular automaton disabled or no config");
-        return;
-    }
+    std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
+    if (!BeginAutomatonUpdate()) return;
+
+    AutomatonStepStats stats;
+    bool computed = AdvanceGeneration(stats);
+    m_generation++;
+    PublishSnapshot();
+    LogGeneration(stats, computed);
+}
 
-    if (m_automatonConfig->GetAllRules().empty()) {
-        Logger::Log("ERROR: No cellular automaton rules available!");
-        return;
+/// <summary>
+/// Режим AutomatonFrameBudgetMs: продолжает поколение из очереди кусками строк, пока не выйдет бюджет кадра.
+/// Поколение публикуется целиком, когда посчитана последняя строка; до этого рендер видит прошлый снимок
+/// </summary>
+void World::ContinueGeneration() {
+    int budgetMs = m_frameBudgetMs;
+    if (budgetMs <= 0) return;
+
+    std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
+    auto frameStart = std::chrono::steady_clock::now();
+
+    // Правила перезагрузили между кадрами - слоты и правила, по которым считались строки, устарели
+    if (m_chunkedGenerationActive &&
+        (m_rulesBindingDirty || !m_automatonConfig || m_boundRulesRevision != m_automatonConfig->GetRevision())) {
+        AbandonChunkedGeneration();
     }
 
-    std::vector<std::vector<int>> newMap = m_map;
-    bool changed = false;
-    int deaths = 0;
-    int births = 0;
-    int naturalDeaths = 0;
+    if (!m_chunkedGenerationActive) {
+        {
+            std::lock_guard<std::mutex> requestLock(m_requestMutex);
+            if (m_pendingGenerations == 0) return;
+            m_pendingGenerations--;
+        }
+        if (!BeginAutomatonUpdate()) return;
+
+        if (!BeginGeneration(m_chunkedFullUpdate)) {
+            // Повтор записанного цикла - копия готового состояния, укладывается в один кадр
+            m_generation++;
+            PublishSnapshot();
+            LogGeneration(AutomatonStepStats(), false);
+            return;
+        }
 
-    for (int y = 1; y < m_height - 1; y++) {
-        for (int x = 1; x < m_width - 1; x++) {
-            if (x == 0 || x == m_width - 1 || y == 0 || y == m_height - 1) {
-                continue;
-            }
+        m_chunkedGenerationActive = true;
+        m_chunkedFrames = 0;
+        m_chunkedStepMs = 0.0;
+        m_chunkedStats = AutomatonStepStats();
+        if (m_chunkedFullUpdate) {
+            EnterChunkedPhase(m_useBitplaneKernel ? ChunkedPhase::Planes : ChunkedPhase::Rows);
+        }
+        else {
+            EnterChunkedPhase(ChunkedPhase::Dilate);
+        }
+    }
 
-            char currentChar = GetTileCharacter(m_map[y][x]);
-            const CellRule* rule = m_automatonConfig->GetRule(currentChar);
-            auto neighborCounts = CountNeighbors(x, y, m_map);
-
-            if (m_map[y][x] != 0 && rule && rule->deathRule) {
-                bool shouldDie = rule->deathRule->evaluate(neighborCounts);
-                if (shouldDie) {
-                    newMap[y][x] = 0;
-                    changed = true;
-                    deaths++;
-                    naturalDeaths++;
-                    if (naturalDeaths <= 3) {
-                        Logger::Log("NATURAL DEATH at " + std::to_string(x) + "," + std::to_string(y) +
-                            " - '" + std::string(1, currentChar) + "'");
-                    }
-                    continue;
-                }
-            }
+    // Каждая фаза идет кусками строк; размер куска берется из измеренного времени строки
+    // с запасом вдвое, чтобы последний кусок кадра не вылез за бюджет
+    auto elapsedMs = [&frameStart]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    };
+    int minChunkRows = m_threadPool.GetThreadCount();
+    int chunkRows = minChunkRows;
+    int rowsThisFrame = 0;
+    while (m_chunkedPhase != ChunkedPhase::Commit && elapsedMs() < budgetMs) {
+        auto chunkStart = std::chrono::steady_clock::now();
+        int firstRow = m_chunkedNextRow;
+        int lastRow = std::min(m_height - 1, firstRow + chunkRows);
+
+        switch (m_chunkedPhase) {
+        case ChunkedPhase::Dilate:
+            DilateChangedRows(firstRow, lastRow);
+            break;
+        case ChunkedPhase::Activate:
+            MarkActiveRows(firstRow, lastRow);
+            break;
+        case ChunkedPhase::Planes:
+            ForEachRowBand(firstRow, lastRow, [&](int, int bandFirstRow, int bandLastRow) {
+                BuildBitplaneRows(bandFirstRow, bandLastRow, m_map);
+            });
+            break;
+        default:
+            RunAutomatonRows(firstRow, lastRow, m_map, m_nextMap, m_chunkedStats);
+            break;
+        }
 
-            if (m_map[y][x] != 0) {
-                if (rule && rule->survivalRule) {
-                    bool shouldSurvive = rule->survivalRule->evaluate(neighborCounts);
-                    if (!shouldSurvive) {
-                        newMap[y][x] = 0;
-                        changed = true;
-                        deaths++;
-                    }
-                }
-            }
-            else {
-                const auto& allRules = m_automatonConfig->GetAllRules();
-                for (auto it = allRules.begin(); it != allRules.end(); ++it) {
-                    char tileChar = it->first;
-                    const CellRule& birthRule = it->second;
-
-                    if (birthRule.birthRule && birthRule.birthRule->evaluate(neighborCounts)) {
-                        int newTileId = FindTileIdByCharacter(tileChar);
-                        if (newTileId != -1) {
-                            newMap[y][x] = newTileId;
-                            changed = true;
-                            births++;
-                            break;
-                        }
-                    }
-                }
-            }
+        double chunkMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - chunkStart).count();
+        double msPerRow = std::max(chunkMs / std::max(1, lastRow - firstRow), 1e-6);
+        chunkRows = std::max(minChunkRows, static_cast<int>((budgetMs - elapsedMs()) / (2.0 * msPerRow)));
+        rowsThisFrame += lastRow - firstRow;
+        m_chunkedNextRow = lastRow;
+        if (m_chunkedNextRow < m_height - 1) continue;
+
+        chunkRows = minChunkRows;
+        switch (m_chunkedPhase) {
+        case ChunkedPhase::Dilate:
+            EnterChunkedPhase(ChunkedPhase::Activate);
+            break;
+        case ChunkedPhase::Activate:
+            EnterChunkedPhase(m_useBitplaneKernel ? ChunkedPhase::Planes : ChunkedPhase::Rows);
+            break;
+        case ChunkedPhase::Planes:
+            EnterChunkedPhase(ChunkedPhase::Rows);
+            break;
+        default:
+            EnterChunkedPhase(ChunkedPhase::Commit);
+            break;
         }
     }
+    m_chunkedFrames++;
 
-    if (changed) {
-        m_map = newMap;
-        Logger::Log("Cellular automaton: " + std::to_string(births) + " births, " +
-            std::to_string(deaths) + " deaths (" + std::to_string(naturalDeaths) + " natural)");
+    // Фиксация (хеш, смена буферов, снимок) проходит по всей карте - в отдельном кадре, если бюджет кончился
+    if (m_chunkedPhase != ChunkedPhase::Commit || (rowsThisFrame > 0 && elapsedMs() >= budgetMs)) {
+        m_chunkedStepMs += elapsedMs();
+        return;
     }
 
-    Logger::Log("=== CELLULAR AUTOMATON UPDATE COMPLETE ===");
+    m_chunkedGenerationActive = false;
+    FinishGeneration(m_chunkedStats, m_chunkedFullUpdate);
+    m_generation++;
+    PublishSnapshot();
+    m_chunkedStepMs += elapsedMs();
+
+    Logger::Log("Cellular automaton: generation " + std::to_string(m_generation) + " took " +
+        std::to_string(m_chunkedFrames) + " frames (" + std::to_string(m_chunkedStepMs) + " ms, budget " +
+        std::to_string(budgetMs) + " ms per frame)");
+    LogGeneration(m_chunkedStats, true);
 }
 
 /// <summary>
-/// Подсчет соседей каждого типа вокруг клетки
+/// Переход поколения по частям к фазе phase с первой строки
 /// </summary>
-std::unordered_map<char, int> World::CountNeighbors(int x, int y, const std::vector<std::vector<int>>& currentMap) const {
-    std::unordered_map<char, int> counts;
-
-    int radius = m_config.GetNeighborRadius();
+void World::EnterChunkedPhase(ChunkedPhase phase) {
+    m_chunkedPhase = phase;
+    m_chunkedNextRow = 1;
 
-    // Окрестность фон Неймана
-    if (radius == 0) {
-        CheckNeighbor(x, y, -1, 0, currentMap, counts);
-        CheckNeighbor(x, y, 1, 0, currentMap, counts); 
-        CheckNeighbor(x, y, 0, -1, currentMap, counts);
-        CheckNeighbor(x, y, 0, 1, currentMap, counts);
+    if (phase == ChunkedPhase::Activate) {
+        m_activeCellCount = 0;
     }
-    else { // Окресть Мура
-        for (int dy = -radius; dy <= radius; dy++) {
-            for (int dx = -radius; dx <= radius; dx++) {
-                if (dx == 0 && dy == 0) continue;
-                CheckNeighbor(x, y, dx, dy, currentMap, counts);
-            }
-        }
+    else if (phase == ChunkedPhase::Planes) {
+        PrepareBitplanes();
+    }
+    else if (phase == ChunkedPhase::Rows && !m_useBitplaneKernel) {
+        // Префиксные суммы (если выгодны) строятся по всей карте сразу
+        PrepareNeighborCounting(m_map, m_activeCellCount, false);
     }
-
-    return counts;
 }
 
 /// <summary>
-/// Вспомогательный метод для проверки одного соседа
+/// Бросает недосчитанное поколение: карта, тайлы или правила изменились между кадрами.
+/// Частично записанный m_nextMap больше не годится, поэтому поколение ставится в очередь заново и считается целиком
 /// </summary>
-void World::CheckNeighbor(int x, int y, int dx, int dy,
-    const std::vector<std::vector<int>>& currentMap,
-    std::unordered_map<char, int>& counts) const {
-    int nx = x + dx;
-    int ny = y + dy;
+void World::AbandonChunkedGeneration() {
+    if (!m_chunkedGenerationActive) return;
+
+    // Часть строк m_nextMap уже посчитана, а фронт изменений собран для брошенного поколения
+    m_chunkedGenerationActive = false;
+    m_automatonFullUpdate = true;
+    {
+        std::lock_guard<std::mutex> requestLock(m_requestMutex);
+        m_pendingGenerations = std::min(MaxPendingGenerations, m_pendingGenerations + 1);
+    }
+    Logger::Log("Cellular automaton: generation in progress restarted after " + std::to_string(m_chunkedFrames) +
+        " frames (map, tiles or rules changed)");
+}
 
-    if (nx <= 0 || nx >= m_width - 1 || ny <= 0 || ny >= m_height - 1) {
+void World::LogGeneration(const AutomatonStepStats& stats, bool computed) const {
+    long long interiorCells = static_cast<long long>(m_width - 2) * (m_height - 2);
+
+    if (!computed) {
+        Logger::Log("Cellular automaton: replayed state " + std::to_string(m_cyclePosition + 1) + "/" +
+            std::to_string(m_cyclePeriod) + " of period-" + std::to_string(m_cyclePeriod) + " cycle, " +
+            std::to_string(m_skippedGenerations) + " generations (" +
+            std::to_string(m_skippedGenerations * interiorCells) + " cell updates) skipped");
+        Logger::Log("=== CELLULAR AUTOMATON UPDATE COMPLETE ===");
         return;
     }
 
-    if (nx >= 0 && nx < m_width && ny >= 0 && ny < m_height) {
-        char neighborChar = GetTileCharacter(currentMap[ny][nx]);
-        counts[neighborChar]++;
+    for (int i = 0; i < stats.naturalDeaths && i < MaxLoggedNaturalDeaths; i++) {
+        const auto& death = stats.loggedNaturalDeaths[i];
+        Logger::Log("NATURAL DEATH at " + std::to_string(death.x) + "," + std::to_string(death.y) +
+            " - '" + std::string(1, death.tile) + "'");
     }
+
+    Logger::Log("Cellular automaton: " + std::to_string(stats.births) + " births, " +
+        std::to_string(stats.deaths) + " deaths (" + std::to_string(stats.naturalDeaths) + " natural), " +
+        std::to_string(m_activeCellCount) + "/" + std::to_string(interiorCells) + " active cells");
+
+    Logger::Log("=== CELLULAR AUTOMATON UPDATE COMPLETE ===");
 }
 
 /// <summary>
-/// Возвращение ID тайла в игровых координатах (без учета границы)
+/// Продвигает автомат на generations поколений. Пока правила считаются по клеткам, карта режется
+/// на тайлы размером с L2 с перекрытием depth * радиус окрестности: каждый тайл проходит depth поколений
+/// подряд в своем буфере, и карта читается и пишется один раз на depth поколений, а не на каждое
 /// </summary>
-/// <param name="x"></param>
-/// <param name="y"></param>
-/// <returns></returns>
-int World::GetTileAt(int x, int y) const {
-    // Координаты передаются для игровой области (0,0 - левый верхний угол игрового пространства)
-    int mapX = x + 1;
-    int mapY = y + 1;
+void World::StepAutomaton(int generations) {
+    std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
+    if (generations <= 0) return;
+    AbandonChunkedGeneration();
+    if (!BeginAutomatonUpdate()) return;
+
+    auto startTime = std::chrono::steady_clock::now();
+    long long births = 0;
+    long long deaths = 0;
+    int blockedGenerations = 0;
+    int replayedGenerations = 0;
+    bool settled = false;
+    long long interiorCells = static_cast<long long>(m_width - 2) * (m_height - 2);
+    int frontierSide = 2 * m_neighborShape.GetRadius() + 1;
+
+    for (int done = 0; done < generations; ) {
+        // Повтор цикла и почти неподвижная карта дешевле через обычный шаг с фронтом изменений
+        int depth = settled || m_cycleConfirmed ? 1 : SelectBlockDepth(generations - done);
+        AutomatonStepStats stats;
+
+        if (depth > 1) {
+            int lastGenerationChanges = 0;
+            stats = RunBlockedGenerations(depth, lastGenerationChanges);
+            settled = 2LL * lastGenerationChanges * frontierSide * frontierSide < interiorCells;
+            blockedGenerations += depth;
+        }
+        else if (!AdvanceGeneration(stats)) {
+            replayedGenerations++;
+        }
 
-    if (mapX >= 0 && mapX < m_width && mapY >= 0 && mapY < m_height) {
-        return m_map[mapY][mapX];
+        births += stats.births;
+        deaths += stats.deaths;
+        done += depth;
+        m_generation += depth; // по номеру поколения выбираются кольца детализации
     }
-    return 0;
+    PublishSnapshot();
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    Logger::Log("Cellular automaton: stepped " + std::to_string(generations) + " generations in " +
+        std::to_string(elapsedMs) + " ms (" + std::to_string(blockedGenerations) + " in tile blocks, " +
+        std::to_string(replayedGenerations) + " replayed), " + std::to_string(births) + " births, " +
+        std::to_string(deaths) + " deaths");
 }
 
 /// <summary>
-/// Преобразование ID тайла в символ для отображения
+/// Ставит поколения в очередь фонового потока и сразу возвращается.
+/// Результат появляется в GetSnapshot(); при переполнении очереди лишние запросы отбрасываются
 /// </summary>
-char World::GetTileCharacter(int tileId) const {
-    if (!m_tileManager) return '.';
-    TileType* tile = m_tileManager->GetTileType(tileId);
-    return tile ? tile->GetCharacter() : '.';
+void World::RequestGenerations(int generations) {
+    if (generations <= 0) return;
+
+    // В режиме бюджета кадра очередь разбирает ContinueGeneration в потоке игры
+    if (m_frameBudgetMs == 0 && !m_automatonWorker.joinable()) {
+        m_automatonWorker = std::thread(&World::AutomatonWorkerLoop, this);
+    }
+
+    {
+        std::lock_guard<std::mutex> requestLock(m_requestMutex);
+        m_pendingGenerations = std::min(MaxPendingGenerations, m_pendingGenerations + generations);
+    }
+    m_requestReady.notify_one();
 }
 
-/// <summary>
-/// Находит ID тайла по его символу
-/// </summary>
-int World::FindTileIdByCharacter(char character) const {
-    if (!m_tileManager) return -1;
+void World::AutomatonWorkerLoop() {
+    std::unique_lock<std::mutex> requestLock(m_requestMutex);
+    while (true) {
+        m_requestReady.wait(requestLock, [this]() { return m_stopWorker || (m_pendingGenerations > 0 && m_frameBudgetMs == 0); });
+        if (m_stopWorker) return;
 
-    const auto& allTiles = m_tileManager->GetAllTiles();
-    for (const auto& pair : allTiles) {
-        const TileType& tile = pair.second;
-        if (tile.GetCharacter() == character) {
-            return tile.GetId();
-        }
+        m_pendingGenerations--;
+        requestLock.unlock();
+        UpdateCellularAutomaton();
+        requestLock.lock();
+    }
+}
+
+void World::StopAutomatonWorker() {
+    if (!m_automatonWorker.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> requestLock(m_requestMutex);
+        m_stopWorker = true;
     }
-    return -1;
+    m_requestReady.notify_one();
+    m_automatonWorker.join();
 }
 
 /// <summary>
-/// Обновление внешнего вида всех тайлов после изменений конфигураций
+/// Публикует копию текущей карты: читатели держат свой shared_ptr, пока он им нужен.
+/// Копия пишется в буфер из пула, который уже никто не держит (сетка того же размера копируется
+/// без выделения памяти); новый буфер создается, только если все буферы пула заняты читателями
 /// </summary>
-void World::UpdateTileAppearance() {
-    if (!m_tileManager) return;
+void World::PublishSnapshot() {
+    std::shared_ptr<WorldSnapshot> snapshot;
+    for (const auto& pooled : m_snapshotPool) {
+        // Пул - единственный владелец: буфер не опубликован и не удерживается читателем.
+        // Новую ссылку читатель может взять только из m_snapshot, поэтому буфер свободен до публикации
+        if (pooled.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            snapshot = pooled;
+            break;
+        }
+    }
 
-    Logger::Log("Updating tile appearances...");
-    int changes = 0;
+    if (!snapshot) {
+        snapshot = std::make_shared<WorldSnapshot>();
+        if (m_snapshotPool.size() < SnapshotPoolSize) {
+            m_snapshotPool.push_back(snapshot);
+        }
+        else {
+            // Занятый буфер остается у своих читателей, пул забывает о нем
+            m_snapshotPool[m_nextPooledSnapshot] = snapshot;
+            m_nextPooledSnapshot = (m_nextPooledSnapshot + 1) % SnapshotPoolSize;
+        }
+    }
 
-    for (int y = 1; y < m_height - 1; y++) {
-        for (int x = 1; x < m_width - 1; x++) {
-            int tileId = m_map[y][x];
-            TileType* tile = m_tileManager->GetTileType(tileId);
+    snapshot->grid = m_map;
+    snapshot->generation = m_generation;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const WorldSnapshot>(std::move(snapshot)));
+}
 
-            if (!tile) {
-                m_map[y][x] = GetTileCharacter(0);
-                changes++;
-            }
-        }
+bool World::BeginAutomatonUpdate() {
+    if (!m_automatonEnabled || !m_tileManager || !m_automatonConfig) {
+        Logger::Log("Cellular automaton disabled or no config");
+        return false;
     }
 
-    if (changes > 0) {
-        Logger::Log("Updated " + std::to_string(changes) + " tile appearances");
+    if (m_automatonConfig->GetAllRules().empty()) {
+        Logger::Log("ERROR: No cellular automaton rules available!");
+        return false;
     }
+
+    EnsureRulesBound();
+    return true;
 }
 
 /// <summary>
-/// Замена удаленных тайлов на тайлы по умолчанию
+/// Одно поколение по всей карте. Возвращает false, если поколение взято из записанного цикла
 /// </summary>
-void World::RemoveDeletedTiles(const std::unordered_set<int>& removedTileIds) {
-    if (removedTileIds.empty()) return;
+bool World::AdvanceGeneration(AutomatonStepStats& stats) {
+    bool fullUpdate = false;
+    if (!BeginGeneration(fullUpdate)) return false;
+
+    if (!fullUpdate) {
+        BuildActiveFrontier();
+    }
+    PrepareAutomatonStep(m_map);
+
+    stats = AutomatonStepStats();
+    RunAutomatonRows(1, m_height - 1, m_map, m_nextMap, stats);
+    FinishGeneration(stats, fullUpdate);
+    return true;
+}
+
+/// <summary>
+/// Начало поколения m_map -> m_nextMap. false - поколение взято из записанного цикла и уже готово;
+/// иначе fullUpdate сообщает, считаются ли все клетки или фронт изменений еще нужно построить
+/// </summary>
+bool World::BeginGeneration(bool& fullUpdate) {
+    // После генерации, перезагрузки правил или правки тайлов считаются все клетки,
+    // иначе только окрестность клеток, изменившихся в прошлом поколении
+    size_t cellCount = static_cast<size_t>(m_width) * static_cast<size_t>(m_height);
+    if (m_changedCells.size() != cellCount) {
+        m_automatonFullUpdate = true;
+    }
+    if (m_automatonFullUpdate) {
+        // Карта или правила изменились извне - записанный цикл больше не действителен
+        ResetCycleDetection();
+    }
+    else if (m_cycleConfirmed) {
+        ReplayCycle();
+        return false;
+    }
+
+    fullUpdate = m_automatonFullUpdate;
+    if (fullUpdate) {
+        ResetActiveFrontier();
+    }
+
+    // Игрок может двигаться, пока поколение считается по частям - центр колец фиксируется на все поколение
+    m_detailCenterX = std::max(1, std::min(m_width - 2, m_detailFocusX.load()));
+    m_detailCenterY = std::max(1, std::min(m_height - 2, m_detailFocusY.load()));
+    return true;
+}
+
+/// <summary>
+/// Все строки поколения посчитаны: m_nextMap становится текущей картой
+/// </summary>
+void World::FinishGeneration(const AutomatonStepStats& stats, bool fullUpdate) {
+    m_automatonFullUpdate = false;
+
+    if (stats.births + stats.deaths > 0) {
+        std::swap(m_map, m_nextMap);
+    }
+
+    UpdateGridHash(fullUpdate);
+
+    // С кольцами детализации состояние - это еще и ждущие клетки, повтор карты не означает цикл.
+    // Вероятностные правила могут изменить клетку и без изменений вокруг: фронт изменений не годится,
+    // следующее поколение снова считает все клетки
+    if (HasStochasticRules()) {
+        m_automatonFullUpdate = true;
+    }
+    else if (IsDetailEnabled()) {
+        ResetCycleDetection();
+    }
+    else {
+        TrackCycle();
+    }
+}
+
+/// <summary>
+/// Сколько поколений считать одним блоком тайлов: перекрытие depth * радиус не должно занимать
+/// больше половины стороны тайла. 1 - блоки не выгодны: битовые плоскости или радиус,
+/// при котором соседей выгоднее считать префиксными суммами по всей карте
+/// </summary>
+int World::SelectBlockDepth(int remainingGenerations) const {
+    int areaRadius = m_neighborShape.IsSquare() ? m_neighborShape.GetRadius() : 0;
+    long long cellCount = static_cast<long long>(m_width - 2) * (m_height - 2);
+    if (m_useBitplaneKernel || IsDetailEnabled() || HasStochasticRules() ||
+        SummedAreaCounter::IsWorthwhile(areaRadius, m_countedSlotCount, cellCount, m_width, m_height, GetAreaTableLimitBytes())) {
+        return 1;
+    }
+
+    int step = m_neighborShape.GetRadius();
+    int depth = std::min(remainingGenerations, MaxBlockGenerations);
+    while (depth > 1 && 4 * depth * step > GetBlockTileSide()) {
+        depth--;
+    }
+    return depth;
+}
+
+int World::GetBlockTileSide() const {
+    // Два буфера тайла должны поместиться в BlockTileBytes
+    int cellBytes = m_map.IsWide() ? sizeof(TileGrid::WideId) : sizeof(TileGrid::NarrowId);
+    return static_cast<int>(std::sqrt(static_cast<double>(BlockTileBytes) / (2 * cellBytes)));
+}
+
+/// <summary>
+/// Буферы тайлов для laneCount дорожек со стороной не меньше side. Пересоздаются, только если их не хватает
+/// или сменилась ширина ячейки карты, поэтому обычный блочный шаг память не выделяет
+/// </summary>
+void World::PrepareBlockScratch(int laneCount, int side) {
+    side = std::max(side, GetBlockTileSide());
+    int maxTileId = m_map.IsWide() ? TileGrid::WideSentinelId : 0;
+    if (static_cast<int>(m_blockScratch.size()) < laneCount) {
+        m_blockScratch.resize(laneCount);
+    }
+
+    for (BlockScratch& scratch : m_blockScratch) {
+        if (scratch.source.IsWide() != m_map.IsWide() || scratch.source.GetWidth() < side || scratch.source.GetHeight() < side) {
+            scratch.source.Resize(side, side, maxTileId);
+            scratch.target.Resize(side, side, maxTileId);
+        }
+    }
+}
+
+/// <summary>
+/// depth поколений тайлами с перекрытием: тайлы читают m_map, пишут свое ядро в m_nextMap
+/// </summary>
+World::AutomatonStepStats World::RunBlockedGenerations(int depth, int& lastGenerationChanges) {
+    int overlap = depth * m_neighborShape.GetRadius();
+    int columns = m_width - 2;
+    int rows = m_height - 2;
+
+    // Ядро тайла - сторона тайла без перекрытия, но тайлов должно хватить на все потоки
+    int coreSide = GetBlockTileSide() - 2 * overlap;
+    int bandCount = m_threadPool.GetThreadCount() * BandsPerThread;
+    int balancedSide = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(columns) * rows / bandCount)));
+    coreSide = std::max(1, std::min(coreSide, std::max(2 * overlap, balancedSide)));
+
+    int tilesX = (columns + coreSide - 1) / coreSide;
+    int tilesY = (rows + coreSide - 1) / coreSide;
+    int tileCount = tilesX * tilesY;
+    std::vector<AutomatonStepStats> tileStats(tileCount);
+    std::vector<int> tileChanges(tileCount, 0);
+
+    // Одна дорожка на поток пула со своими буферами тайла; тайлы дорожки разбирают через общий счетчик
+    int laneCount = std::min(m_threadPool.GetThreadCount(), tileCount);
+    PrepareBlockScratch(laneCount, coreSide + 2 * overlap);
+    std::atomic<int> nextTile(0);
+
+    m_threadPool.ParallelFor(laneCount, [&](int lane) {
+        for (int tile = nextTile.fetch_add(1); tile < tileCount; tile = nextTile.fetch_add(1)) {
+            int firstX = 1 + (tile % tilesX) * coreSide;
+            int firstY = 1 + (tile / tilesX) * coreSide;
+            StepAutomatonTile(firstX, firstY, std::min(firstX + coreSide, m_width - 1), std::min(firstY + coreSide, m_height - 1),
+                depth, m_map, m_nextMap, m_blockScratch[lane], tileStats[tile], tileChanges[tile]);
+        }
+    });
+    std::swap(m_map, m_nextMap);
+
+    // m_nextMap теперь отстает на depth поколений, а фронт изменений устарел
+    m_automatonFullUpdate = true;
+
+    AutomatonStepStats total;
+    lastGenerationChanges = 0;
+    for (size_t tile = 0; tile < tileStats.size(); tile++) {
+        total.births += tileStats[tile].births;
+        total.deaths += tileStats[tile].deaths;
+        total.naturalDeaths += tileStats[tile].naturalDeaths;
+        lastGenerationChanges += tileChanges[tile];
+    }
+    return total;
+}
+
+/// <summary>
+/// depth поколений для ядра [firstX, lastX) x [firstY, lastY). Тайл берется с перекрытием depth * радиус;
+/// после поколения g верна область, отстоящая от края тайла на g * радиус, и после depth поколений это ядро.
+/// Статистика собирается только по клеткам ядра, чтобы перекрытия соседних тайлов не считались дважды
+/// </summary>
+void World::StepAutomatonTile(int firstX, int firstY, int lastX, int lastY, int depth, const TileGrid& currentMap,
+    TileGrid& newMap, BlockScratch& scratch, AutomatonStepStats& stats, int& lastGenerationChanges) const {
+    int step = m_neighborShape.GetRadius();
+    int overlap = depth * step;
+    int originX = firstX - overlap;
+    int originY = firstY - overlap;
+    int width = lastX - firstX + 2 * overlap;
+    int height = lastY - firstY + 2 * overlap;
+
+    // Буферы дорожки не меньше тайла; используется их левый верхний угол width x height
+    TileGrid* source = &scratch.source;
+    TileGrid* target = &scratch.target;
+
+    currentMap.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
+        const Cell sentinel = static_cast<Cell>(source->GetSentinelId());
+
+        // Граница карты и все, что за ней, - SentinelId: эти клетки не пересчитываются
+        int firstInteriorX = std::max(0, 1 - originX);
+        int lastInteriorX = std::min(width, m_width - 1 - originX);
+        for (int ty = 0; ty < height; ty++) {
+            Cell* row = source->Row<Cell>(ty);
+            std::fill_n(row, width, sentinel);
+
+            int y = originY + ty;
+            if (y >= 1 && y < m_height - 1) {
+                const Cell* mapRow = currentMap.Row<Cell>(y) + originX;
+                std::copy(mapRow + firstInteriorX, mapRow + lastInteriorX, row + firstInteriorX);
+            }
+            // Клетки вне пересчитываемой области (граница и край перекрытия) одинаковы в обоих буферах
+            std::copy(row, row + width, target->Row<Cell>(ty));
+        }
+
+        NeighborCounts neighborCounts;
+        AutomatonStepStats overlapStats;
+        const NeighborCounts::Slot* slotByTileId = m_countedSlotByTileId.data();
+        m_neighborShape.Dispatch(source->GetStride(), [&](const auto& kernel) {
+            for (int generation = 1; generation <= depth; generation++) {
+                int margin = generation * step;
+                int firstTy = std::max(margin, 1 - originY);
+                int lastTy = std::min(height - margin, m_height - 1 - originY);
+                int firstTx = std::max(margin, firstInteriorX);
+                int lastTx = std::min(width - margin, lastInteriorX);
+                int changesBefore = stats.births + stats.deaths;
+
+                for (int ty = firstTy; ty < lastTy; ty++) {
+                    const Cell* row = source->Row<Cell>(ty);
+                    Cell* newRow = target->Row<Cell>(ty);
+                    bool coreRow = ty >= overlap && ty < height - overlap;
+
+                    for (int tx = firstTx; tx < lastTx; tx++) {
+                        bool coreCell = coreRow && tx >= overlap && tx < width - overlap;
+                        neighborCounts.Clear(m_countedSlotCount);
+                        kernel.Count(row + tx, slotByTileId, neighborCounts);
+                        newRow[tx] = EvaluateCell<Cell>(originX + tx, originY + ty, row[tx], neighborCounts,
+                            coreCell ? stats : overlapStats);
+                    }
+                }
+
+                std::swap(source, target);
+                lastGenerationChanges = stats.births + stats.deaths - changesBefore;
+            }
+        });
+
+        for (int y = firstY; y < lastY; y++) {
+            const Cell* row = source->Row<Cell>(y - originY) + overlap;
+            std::copy(row, row + (lastX - firstX), newMap.Row<Cell>(y) + firstX);
+        }
+    });
+}
+
+/// <summary>
+/// Хеш карты как сумма перемешанных хешей строк: после шага пересчитываются только изменившиеся строки
+/// </summary>
+void World::UpdateGridHash(bool allRows) {
+    if (m_rowHashes.size() != static_cast<size_t>(m_height)) {
+        m_rowHashes.assign(m_height, 0);
+        m_gridHash = 0;
+        allRows = true;
+    }
+
+    m_map.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
+
+        for (int y = 1; y < m_height - 1; y++) {
+            if (!allRows && !m_rowChanged[y]) continue;
+
+            // FNV-1a по клеткам строки, затем перемешивание с номером строки
+            const Cell* row = m_map.Row<Cell>(y);
+            std::uint64_t rowHash = 0xCBF29CE484222325ULL;
+            for (int x = 1; x < m_width - 1; x++) {
+                rowHash = (rowHash ^ row[x]) * 0x100000001B3ULL;
+            }
+            rowHash = MixHash(rowHash + static_cast<std::uint64_t>(y) * 0x9E3779B97F4A7C15ULL);
+
+            m_gridHash += rowHash - m_rowHashes[y];
+            m_rowHashes[y] = rowHash;
+        }
+    });
+}
+
+/// <summary>
+/// Ищет текущий хеш в истории поколений. Совпадение через N поколений - кандидат в цикл периода N
+/// (N = 1 - неподвижное состояние): следующие N состояний записываются, и если за ними карта
+/// точно совпадает с первым записанным, дальше поколения повторяются из записи без пересчета
+/// </summary>
+void World::TrackCycle() {
+    if (m_cyclePeriod > 0) {
+        if (static_cast<int>(m_cycleStates.size()) < m_cyclePeriod) {
+            m_cycleStates.push_back(m_map);
+        }
+        else {
+            bool repeats = true;
+            m_map.Dispatch([&](auto cellTag) {
+                using Cell = decltype(cellTag);
+                const TileGrid& first = m_cycleStates.front();
+                for (int y = 1; y < m_height - 1 && repeats; y++) {
+                    repeats = std::equal(m_map.Row<Cell>(y) + 1, m_map.Row<Cell>(y) + m_width - 1, first.Row<Cell>(y) + 1);
+                }
+            });
+
+            if (repeats) {
+                m_cycleConfirmed = true;
+                m_cyclePosition = 0;
+                Logger::Log(m_cyclePeriod == 1
+                    ? std::string("Automaton reached a still life, replaying it until the map changes")
+                    : "Automaton entered a period-" + std::to_string(m_cyclePeriod) +
+                      " cycle, replaying recorded states until the map changes");
+                return;
+            }
+
+            // Совпадение хешей было случайным
+            m_cyclePeriod = 0;
+            m_cycleStates.clear();
+        }
+    }
+
+    if (m_cyclePeriod == 0) {
+        for (int distance = 1; distance <= static_cast<int>(m_hashHistory.size()); distance++) {
+            if (m_hashHistory[m_hashHistory.size() - distance] == m_gridHash) {
+                m_cyclePeriod = distance;
+                m_cycleStates.assign(1, m_map);
+                break;
+            }
+        }
+    }
+
+    m_hashHistory.push_back(m_gridHash);
+    if (static_cast<int>(m_hashHistory.size()) > MaxCyclePeriod) {
+        m_hashHistory.pop_front();
+    }
+}
+
+/// <summary>
+/// Следующее поколение цикла: m_map обменивается с записанными состояниями без копирования.
+/// Слот m_cyclePosition хранит прежнее содержимое m_map, остальные - состояния цикла
+/// </summary>
+void World::ReplayCycle() {
+    int nextPosition = (m_cyclePosition + 1) % m_cyclePeriod;
+    std::swap(m_map, m_cycleStates[m_cyclePosition]);
+    std::swap(m_map, m_cycleStates[nextPosition]);
+    m_cyclePosition = nextPosition;
+    m_skippedGenerations++;
+}
+
+void World::ResetCycleDetection() {
+    if (m_cycleConfirmed) {
+        long long interiorCells = static_cast<long long>(m_width - 2) * (m_height - 2);
+        Logger::Log("Automaton cycle (period " + std::to_string(m_cyclePeriod) + ") invalidated after " +
+            std::to_string(m_skippedGenerations) + " replayed generations (" +
+            std::to_string(m_skippedGenerations * interiorCells) + " cell updates skipped)");
+    }
+
+    m_hashHistory.clear();
+    m_cycleStates.clear();
+    m_cyclePeriod = 0;
+    m_cycleConfirmed = false;
+    m_cyclePosition = 0;
+    m_skippedGenerations = 0;
+}
+
+/// <summary>
+/// Делит строки [firstRow, lastRow) на полосы пула потоков и вызывает func(полоса, первая строка, конец)
+/// </summary>
+template <typename Func>
+void World::ForEachRowBand(int firstRow, int lastRow, Func&& func) {
+    int rows = lastRow - firstRow;
+    if (rows <= 0) return;
+
+    int bandCount = GetRowBandCount(rows);
+    m_threadPool.ParallelFor(bandCount, [&](int band) {
+        int bandFirstRow = firstRow + static_cast<int>(static_cast<long long>(rows) * band / bandCount);
+        int bandLastRow = firstRow + static_cast<int>(static_cast<long long>(rows) * (band + 1) / bandCount);
+        func(band, bandFirstRow, bandLastRow);
+    });
+}
+
+/// <summary>
+/// Одно поколение currentMap -> newMap целиком (активные строки и клетки - из фронта)
+/// </summary>
+World::AutomatonStepStats World::RunAutomatonStep(const TileGrid& currentMap, TileGrid& newMap) {
+    PrepareAutomatonStep(currentMap);
+
+    AutomatonStepStats total;
+    RunAutomatonRows(1, m_height - 1, currentMap, newMap, total);
+    return total;
+}
+
+/// <summary>
+/// Подсчет соседей для всего поколения: битовые плоскости или префиксные суммы строятся по currentMap целиком
+/// </summary>
+void World::PrepareAutomatonStep(const TileGrid& currentMap) {
+    if (!m_useBitplaneKernel) {
+        PrepareNeighborCounting(currentMap, m_activeCellCount, false);
+        return;
+    }
+
+    PrepareBitplanes();
+    ForEachRowBand(1, m_height - 1, [&](int, int firstRow, int lastRow) {
+        BuildBitplaneRows(firstRow, lastRow, currentMap);
+    });
+}
+
+/// <summary>
+/// Строки [firstRow, lastRow) поколения по полосам на пуле потоков; счетчики полос добавляются к total
+/// в порядке строк, поэтому поколение по частям дает ту же статистику, что и целиком
+/// </summary>
+void World::RunAutomatonRows(int firstRow, int lastRow, const TileGrid& currentMap, TileGrid& newMap,
+    AutomatonStepStats& total) {
+    // Каждая клетка зависит только от предыдущего поколения, поэтому полосы строк
+    // считаются независимо, а результат не зависит от числа потоков
+    if (lastRow <= firstRow) return;
+
+    m_bandStats.assign(GetRowBandCount(lastRow - firstRow), AutomatonStepStats());
+    ForEachRowBand(firstRow, lastRow, [&](int band, int bandFirstRow, int bandLastRow) {
+        if (m_useBitplaneKernel) {
+            StepBitplaneRows(bandFirstRow, bandLastRow, currentMap, newMap, m_bandStats[band]);
+        }
+        else {
+            StepAutomatonRows(bandFirstRow, bandLastRow, currentMap, newMap, m_bandStats[band]);
+        }
+    });
+
+    for (const AutomatonStepStats& stats : m_bandStats) {
+        for (int i = 0; i < stats.naturalDeaths && total.naturalDeaths + i < MaxLoggedNaturalDeaths; i++) {
+            total.loggedNaturalDeaths[total.naturalDeaths + i] = stats.loggedNaturalDeaths[i];
+        }
+        total.births += stats.births;
+        total.deaths += stats.deaths;
+        total.naturalDeaths += stats.naturalDeaths;
+    }
+}
+
+/// <summary>
+/// Шаг автомата для строк [firstRow, lastRow): читает currentMap, пишет только свои строки newMap.
+/// Каждая активная клетка записывается (неизменные - текущим значением), поэтому newMap не нужно копировать заранее.
+/// Неактивные клетки не менялись два поколения, и newMap (прошлое поколение) уже хранит их значение
+/// </summary>
+void World::StepAutomatonRows(int firstRow, int lastRow, const TileGrid& currentMap, TileGrid& newMap,
+    AutomatonStepStats& stats) {
+    NeighborCounts neighborCounts;
+    std::uint8_t ringDue[WorldConfig::MaxDetailRings + 1];
+
+    currentMap.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
+
+        DispatchNeighborCounter<Cell>(currentMap, [&](const auto& countNeighbors) {
+            for (int y = firstRow; y < lastRow; y++) {
+                bool rowActive = m_rowActive[y] != 0;
+                size_t rowOffset = static_cast<size_t>(y) * static_cast<size_t>(m_width);
+                std::uint8_t* pendingRow = nullptr;
+                if (IsDetailEnabled()) {
+                    bool anyDue = BuildDetailDueRings(y, ringDue);
+                    if (!rowActive && !(anyDue && m_detailPendingRows[y])) continue;
+                    pendingRow = m_detailPendingCells.data() + rowOffset;
+                }
+                else if (!rowActive) {
+                    continue;
+                }
+
+                const Cell* row = currentMap.Row<Cell>(y);
+                Cell* newRow = newMap.Row<Cell>(y);
+                const std::uint8_t* activeRow = m_automatonFullUpdate ? nullptr : m_activeCells.data() + rowOffset;
+                std::uint8_t* changedRow = m_changedCells.data() + rowOffset;
+                int distanceY = std::abs(y - m_detailCenterY);
+                bool rowChanged = false;
+                bool rowPending = false;
+
+                for (int x = 1; x < m_width - 1; x++) {
+                    bool active = rowActive && (!activeRow || activeRow[x]);
+
+                    // Кольцо клетки пропускает поколение: клетка остается прежней (во втором буфере тоже),
+                    // а если ее стоило считать - ждет очереди кольца. Все кольца читают одно прошлое поколение
+                    if (pendingRow) {
+                        int distance = std::max(std::abs(x - m_detailCenterX), distanceY);
+                        if (!ringDue[m_detailRingByDistance[distance]]) {
+                            if (active) {
+                                pendingRow[x] = 1;
+                                newRow[x] = row[x];
+                                changedRow[x] = 0;
+                            }
+                            rowPending = rowPending || pendingRow[x];
+                            continue;
+                        }
+                        active = active || pendingRow[x];
+                        pendingRow[x] = 0;
+                    }
+                    if (!active) continue;
+
+                    countNeighbors(x, y, neighborCounts);
+                    newRow[x] = EvaluateCell<Cell>(x, y, row[x], neighborCounts, stats);
+                    changedRow[x] = newRow[x] != row[x];
+                    rowChanged = rowChanged || changedRow[x];
+                }
+
+                m_rowChanged[y] = rowChanged;
+                if (pendingRow) {
+                    m_detailPendingRows[y] = rowPending;
+                }
+            }
+        });
+    });
+}
+
+/// <summary>
+/// Новое значение клетки по правилам: через таблицу исходов или вычислением правил
+/// </summary>
+template <typename Cell>
+Cell World::EvaluateCell(int x, int y, int tileId, const NeighborCounts& neighborCounts, AutomatonStepStats& stats) const {
+    if (m_useOutcomeTable) {
+        std::uint8_t outcome = m_automatonConfig->GetOutcomeTable().Lookup(m_outcomeStateByTileId[tileId], neighborCounts);
+        if (outcome == RuleOutcomeTable::Keep) {
+            return static_cast<Cell>(tileId);
+        }
+
+        if (outcome >= RuleOutcomeTable::FirstBirth) {
+            stats.births++;
+        }
+        else {
+            if (outcome == RuleOutcomeTable::NaturalDeath) {
+                if (stats.naturalDeaths < MaxLoggedNaturalDeaths) {
+                    stats.loggedNaturalDeaths[stats.naturalDeaths] = { x, y, GetTileCharacter(tileId) };
+                }
+                stats.naturalDeaths++;
+            }
+            stats.deaths++;
+        }
+        return static_cast<Cell>(m_outcomeTileIds[outcome]);
+    }
+
+    if (tileId != 0) {
+        const CellRule* rule = m_ruleBySlot[m_slotByTileId[tileId]];
+
+        if (rule && rule->deathRule && RuleFires(*rule->deathRule, neighborCounts, x, y, DeathRuleStream)) {
+            if (stats.naturalDeaths < MaxLoggedNaturalDeaths) {
+                stats.loggedNaturalDeaths[stats.naturalDeaths] = { x, y, GetTileCharacter(tileId) };
+            }
+            stats.deaths++;
+            stats.naturalDeaths++;
+            return 0;
+        }
+        if (rule && rule->survivalRule && !RuleFires(*rule->survivalRule, neighborCounts, x, y, SurvivalRuleStream)) {
+            stats.deaths++;
+            return 0;
+        }
+        return static_cast<Cell>(tileId);
+    }
+
+    for (size_t i = 0; i < m_birthRules.size(); i++) {
+        if (RuleFires(*m_birthRules[i], neighborCounts, x, y, FirstBirthRuleStream + static_cast<int>(i))) {
+            stats.births++;
+            return static_cast<Cell>(m_birthTileIds[i]);
+        }
+    }
+    return 0;
+}
+
+/// <summary>
+/// Выполнено ли правило для клетки. Правило с вероятностью p после выполнения срабатывает с вероятностью p:
+/// случайное число берется по (сид, поколение, x, y, правило), так что шаг остается воспроизводимым
+/// </summary>
+bool World::RuleFires(const RuleParser& rule, const NeighborCounts& neighborCounts, int x, int y, int stream) const {
+    if (!rule.evaluate(neighborCounts)) return false;
+    return !rule.isStochastic() || rule.passesChance(CellRandom(m_ruleRandomKey, m_generation, x, y, stream));
+}
+
+/// <summary>
+/// Правила по слоту тайла и список правил рождения с ID тайлов: шаг автомата не ищет
+/// символ тайла и правило для каждой клетки. Порядок рождения - порядок обхода правил
+/// </summary>
+void World::BuildRuleLookup() {
+    m_ruleBySlot.assign(NeighborCounts::MaxSlots, nullptr);
+    m_birthRules.clear();
+    m_birthTileIds.clear();
+
+    for (const auto& pair : m_automatonConfig->GetAllRules()) {
+        // Символ без тайла родиться не может
+        if (pair.second.birthRule) {
+            int tileId = FindTileIdByCharacter(pair.first);
+            if (tileId != -1) {
+                m_birthRules.push_back(pair.second.birthRule.get());
+                m_birthTileIds.push_back(tileId);
+            }
+        }
+    }
+
+    for (int character = 0; character < 256; character++) {
+        NeighborCounts::Slot slot = m_slotByChar[character];
+        if (slot != NeighborCounts::NoSlot && slot < m_slotCount) {
+            m_ruleBySlot[slot] = m_automatonConfig->GetRule(static_cast<char>(character));
+        }
+    }
+}
+
+/// <summary>
+/// Битовые плоскости подходят, если окрестность - квадрат Мура ограниченного радиуса или фон Нейман
+/// радиуса 1, тайлов мало, а правила состоят только из сравнений count с константой и логических
+/// операций. Готовит список слотов, которые читают правила
+/// </summary>
+bool World::SelectBitplaneKernel() {
+    m_countedSlots.clear();
+
+    int radius = GetBitplaneRadius();
+    bool supportedShape = m_neighborShape.IsSquare() || m_neighborShape.IsVonNeumann(1);
+    if (!m_automatonConfig || !supportedShape || radius > MaxBitplaneRadius || m_ruleSlotCount > MaxBitplaneSlots) {
+        return false;
+    }
+    // Кольца детализации выбирают клетки поштучно, а не словами по 64,
+    // а вероятностным правилам нужно свое случайное число для каждой клетки
+    if (IsDetailEnabled() || HasStochasticRules()) {
+        return false;
+    }
+
+    for (const auto& pair : m_automatonConfig->GetAllRules()) {
+        const CellRule& rule = pair.second;
+        for (const RuleParser* parser : { rule.survivalRule.get(), rule.birthRule.get(), rule.deathRule.get() }) {
+            if (!parser) continue;
+
+            for (const RuleInstruction& instruction : parser->getProgram()) {
+                switch (instruction.op) {
+                case RuleOpCode::PushConst:
+                case RuleOpCode::And:
+                case RuleOpCode::Or:
+                case RuleOpCode::Not:
+                    break;
+                case RuleOpCode::CountLess:
+                case RuleOpCode::CountLessEqual:
+                case RuleOpCode::CountGreater:
+                case RuleOpCode::CountGreaterEqual:
+                case RuleOpCode::CountEqual:
+                case RuleOpCode::CountNotEqual:
+                    if (instruction.slot != NeighborCounts::NoSlot &&
+                        std::find(m_countedSlots.begin(), m_countedSlots.end(), instruction.slot) == m_countedSlots.end()) {
+                        m_countedSlots.push_back(instruction.slot);
+                    }
+                    break;
+                default:
+                    return false; // арифметика над count не раскладывается на бит-срезовые сравнения
+                }
+            }
+        }
+    }
+
+    // Фон Нейман: сумма строки - левый и правый соседи, плюс верхний и нижний; Мур: квадрат с центром минус центр
+    int rowWindow = radius == 0 ? 2 : 2 * radius + 1;
+    m_rowSumBits = BitWidth(rowWindow);
+    m_countBits = BitWidth(radius == 0 ? 4 : rowWindow * rowWindow);
+    return true;
+}
+
+/// <summary>
+/// Размечает строки, плоскости которых нужны активным строкам этого поколения
+/// </summary>
+void World::PrepareBitplanes() {
+    m_wordsPerRow = (m_width + 63) / 64;
+    size_t planeWords = static_cast<size_t>(m_height) * m_wordsPerRow;
+    m_tilePlanes.resize(planeWords * m_ruleSlotCount);
+    m_emptyPlane.resize(planeWords);
+    m_rowSumPlanes.resize(planeWords * m_rowSumBits * m_countedSlots.size());
+
+    int radius = m_neighborShape.GetRadius();
+    m_planeRowNeeded.assign(m_height, 0);
+    for (int y = 1; y < m_height - 1; y++) {
+        if (!m_rowActive[y]) continue;
+
+        int lastRow = std::min(m_height - 2, y + radius);
+        for (int neededRow = std::max(1, y - radius); neededRow <= lastRow; neededRow++) {
+            m_planeRowNeeded[neededRow] = 1;
+        }
+    }
+}
+
+/// <summary>
+/// Раскладывает строки [firstRow, lastRow) по плоскостям слотов и считает суммы по строке
+/// для каждого слота, на который ссылаются правила. Граница карты в плоскости не попадает
+/// </summary>
+void World::BuildBitplaneRows(int firstRow, int lastRow, const TileGrid& currentMap) {
+    int radius = GetBitplaneRadius();
+    size_t planeWords = static_cast<size_t>(m_height) * m_wordsPerRow;
+
+    currentMap.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
+
+        for (int y = firstRow; y < lastRow; y++) {
+            if (!m_planeRowNeeded[y]) continue;
+
+            size_t rowOffset = static_cast<size_t>(y) * m_wordsPerRow;
+            for (int slot = 0; slot < m_ruleSlotCount; slot++) {
+                std::fill_n(m_tilePlanes.data() + slot * planeWords + rowOffset, m_wordsPerRow, 0ULL);
+            }
+            std::fill_n(m_emptyPlane.data() + rowOffset, m_wordsPerRow, 0ULL);
+
+            const Cell* row = currentMap.Row<Cell>(y);
+            for (int x = 1; x < m_width - 1; x++) {
+                std::uint64_t bit = 1ULL << (x & 63);
+                size_t word = rowOffset + (x >> 6);
+                NeighborCounts::Slot slot = m_slotByTileId[row[x]];
+                if (slot < m_ruleSlotCount) {
+                    m_tilePlanes[slot * planeWords + word] |= bit;
+                }
+                if (row[x] == 0) {
+                    m_emptyPlane[word] |= bit;
+                }
+            }
+
+            for (size_t i = 0; i < m_countedSlots.size(); i++) {
+                const std::uint64_t* plane = m_tilePlanes.data() + m_countedSlots[i] * planeWords + rowOffset;
+                std::uint64_t* sums = m_rowSumPlanes.data() + (i * m_height + y) * m_rowSumBits * m_wordsPerRow;
+
+                for (int word = 0; word < m_wordsPerRow; word++) {
+                    std::uint64_t acc[MaxRowSumBits] = {};
+                    if (radius == 0) {
+                        AddBit(acc, m_rowSumBits, ShiftedWord(plane, m_wordsPerRow, word, -1));
+                        AddBit(acc, m_rowSumBits, ShiftedWord(plane, m_wordsPerRow, word, 1));
+                    }
+                    else {
+                        for (int dx = -radius; dx <= radius; dx++) {
+                            AddBit(acc, m_rowSumBits, ShiftedWord(plane, m_wordsPerRow, word, dx));
+                        }
+                    }
+
+                    for (int b = 0; b < m_rowSumBits; b++) {
+                        sums[b * m_wordsPerRow + word] = acc[b];
+                    }
+                }
+            }
+        }
+    });
+}
+
+/// <summary>
+/// Шаг автомата для строк [firstRow, lastRow) по 64 клетки: счетчики соседей складываются из сумм
+/// по строкам, правила вычисляются над масками. Результат и счетчики совпадают с StepAutomatonRows
+/// </summary>
+void World::StepBitplaneRows(int firstRow, int lastRow, const TileGrid& currentMap, TileGrid& newMap,
+    AutomatonStepStats& stats) {
+    int radius = GetBitplaneRadius();
+    size_t planeWords = static_cast<size_t>(m_height) * m_wordsPerRow;
+    std::uint64_t slotCounts[MaxBitplaneSlots * MaxCountBits] = {};
+
+    auto planeWord = [&](int slot, int y, int word) {
+        return m_tilePlanes[slot * planeWords + static_cast<size_t>(y) * m_wordsPerRow + word];
+    };
+    auto rowSums = [&](size_t countedIndex, int y, int word) {
+        return m_rowSumPlanes.data() + (countedIndex * m_height + y) * m_rowSumBits * m_wordsPerRow + word;
+    };
+
+    currentMap.Dispatch([&](auto cellTag) {
+        using Cell = decltype(cellTag);
+
+        for (int y = firstRow; y < lastRow; y++) {
+            if (!m_rowActive[y]) continue;
+
+            const Cell* row = currentMap.Row<Cell>(y);
+            Cell* newRow = newMap.Row<Cell>(y);
+            std::copy(row, row + m_width, newRow);
+
+            size_t cellOffset = static_cast<size_t>(y) * static_cast<size_t>(m_width);
+            const std::uint8_t* activeRow = m_automatonFullUpdate ? nullptr : m_activeCells.data() + cellOffset;
+            std::uint8_t* changedRow = m_changedCells.data() + cellOffset;
+            std::fill(changedRow + 1, changedRow + m_width - 1, static_cast<std::uint8_t>(0));
+            bool rowChanged = false;
+
+            for (int word = 0; word < m_wordsPerRow; word++) {
+                int firstX = std::max(1, word * 64);
+                int lastX = std::min(m_width - 1, word * 64 + 64);
+                if (firstX >= lastX) continue;
+
+                // Клетки, которые StepAutomatonRows вычислил бы в этом поколении
+                std::uint64_t evaluated = 0;
+                for (int x = firstX; x < lastX; x++) {
+                    if (!activeRow || activeRow[x]) {
+                        evaluated |= 1ULL << (x & 63);
+                    }
+                }
+                if (!evaluated) continue;
+
+                for (size_t i = 0; i < m_countedSlots.size(); i++) {
+                    int slot = m_countedSlots[i];
+                    std::uint64_t* acc = slotCounts + slot * MaxCountBits;
+                    std::fill_n(acc, m_countBits, 0ULL);
+
+                    if (radius == 0) {
+                        AddSliced(acc, m_countBits, rowSums(i, y, word), m_rowSumBits, m_wordsPerRow);
+                        if (y - 1 >= 1) AddBit(acc, m_countBits, planeWord(slot, y - 1, word));
+                        if (y + 1 <= m_height - 2) AddBit(acc, m_countBits, planeWord(slot, y + 1, word));
+                    }
+                    else {
+                        int lastRowSum = std::min(m_height - 2, y + radius);
+                        for (int sumRow = std::max(1, y - radius); sumRow <= lastRowSum; sumRow++) {
+                            AddSliced(acc, m_countBits, rowSums(i, sumRow, word), m_rowSumBits, m_wordsPerRow);
+                        }
+                        SubtractBit(acc, m_countBits, planeWord(slot, y, word));
+                    }
+                }
+
+                std::uint64_t empty = m_emptyPlane[static_cast<size_t>(y) * m_wordsPerRow + word] & evaluated;
+                std::uint64_t naturalDeaths = 0;
+                std::uint64_t deaths = 0;
+                for (int slot = 0; slot < m_ruleSlotCount; slot++) {
+                    const CellRule* rule = m_ruleBySlot[slot];
+                    std::uint64_t occupied = planeWord(slot, y, word) & evaluated & ~empty;
+                    if (!rule || !occupied) continue;
+
+                    std::uint64_t natural = rule->deathRule ? EvaluateRuleBits(*rule->deathRule, slotCounts) & occupied : 0;
+                    std::uint64_t failed = rule->survivalRule ? ~EvaluateRuleBits(*rule->survivalRule, slotCounts) & occupied : 0;
+                    naturalDeaths |= natural;
+                    deaths |= natural | failed;
+                }
+
+                for (std::uint64_t bits = naturalDeaths; bits; bits &= bits - 1) {
+                    if (stats.naturalDeaths >= MaxLoggedNaturalDeaths) {
+                        stats.naturalDeaths += PopCount(bits);
+                        break;
+                    }
+                    int x = word * 64 + LowestBit(bits);
+                    stats.loggedNaturalDeaths[stats.naturalDeaths++] = { x, y, GetTileCharacter(row[x]) };
+                }
+                stats.deaths += PopCount(deaths);
+
+                for (std::uint64_t bits = deaths; bits; bits &= bits - 1) {
+                    int x = word * 64 + LowestBit(bits);
+                    newRow[x] = 0;
+                    changedRow[x] = 1;
+                    rowChanged = true;
+                }
+
+                std::uint64_t remaining = empty;
+                for (size_t i = 0; i < m_birthRules.size() && remaining; i++) {
+                    std::uint64_t born = EvaluateRuleBits(*m_birthRules[i], slotCounts) & remaining;
+                    remaining &= ~born;
+                    stats.births += PopCount(born);
+
+                    Cell tileId = static_cast<Cell>(m_birthTileIds[i]);
+                    for (std::uint64_t bits = born; bits; bits &= bits - 1) {
+                        int x = word * 64 + LowestBit(bits);
+                        newRow[x] = tileId;
+                        if (tileId != row[x]) {
+                            changedRow[x] = 1;
+                            rowChanged = true;
+                        }
+                    }
+                }
+            }
+
+            m_rowChanged[y] = rowChanged;
+        }
+    });
+}
+
+/// <summary>
+/// Правило над масками 64 клеток; slotCounts - бит-срезовые счетчики [слот][разряд]
+/// </summary>
+std::uint64_t World::EvaluateRuleBits(const RuleParser& rule, const std::uint64_t* slotCounts) const {
+    if (!rule.isValid()) return 0;
+
+    static const std::uint64_t zeroCount[MaxCountBits] = {};
+    std::uint64_t stack[RuleParser::MaxStackDepth];
+    int top = -1;
+
+    for (const RuleInstruction& instruction : rule.getProgram()) {
+        const std::uint64_t* count = instruction.slot == NeighborCounts::NoSlot
+            ? zeroCount : slotCounts + instruction.slot * MaxCountBits;
+        std::uint64_t less = 0;
+        std::uint64_t equal = 0;
+
+        switch (instruction.op) {
+        case RuleOpCode::PushConst:
+            stack[++top] = instruction.value != 0 ? ~0ULL : 0;
+            continue;
+        case RuleOpCode::And: top--; stack[top] &= stack[top + 1]; continue;
+        case RuleOpCode::Or:  top--; stack[top] |= stack[top + 1]; continue;
+        case RuleOpCode::Not: stack[top] = ~stack[top]; continue;
+        default:
+            break;
+        }
+
+        CompareSliced(count, m_countBits, instruction.value, less, equal);
+        switch (instruction.op) {
+        case RuleOpCode::CountLess:         stack[++top] = less; break;
+        case RuleOpCode::CountLessEqual:    stack[++top] = less | equal; break;
+        case RuleOpCode::CountGreater:      stack[++top] = ~(less | equal); break;
+        case RuleOpCode::CountGreaterEqual: stack[++top] = ~less; break;
+        case RuleOpCode::CountEqual:        stack[++top] = equal; break;
+        case RuleOpCode::CountNotEqual:     stack[++top] = ~equal; break;
+        default:                            stack[++top] = 0; break;
+        }
+    }
+
+    return top >= 0 ? stack[top] : 0;
+}
+
+/// <summary>
+/// Полный пересчет: все строки активны, маски изменений перезаписываются шагом целиком
+/// </summary>
+void World::ResetActiveFrontier() {
+    size_t cellCount = static_cast<size_t>(m_width) * static_cast<size_t>(m_height);
+    m_changedCells.assign(cellCount, 0);
+    m_activeCells.assign(cellCount, 0);
+    m_dilatedRows.assign(cellCount, 0);
+    m_rowChanged.assign(m_height, 0);
+    m_rowActive.assign(m_height, 1);
+    m_activeCellCount = static_cast<long long>(m_width - 2) * (m_height - 2);
+
+    // Все клетки активны - каждая посчитается, когда дойдет очередь ее кольца
+    if (IsDetailEnabled()) {
+        m_detailPendingCells.assign(cellCount, 0);
+        m_detailPendingRows.assign(m_height, 0);
+    }
+}
+
+/// <summary>
+/// Кольца уровней детализации из конфига: кольцо 0 - радиус AutomatonDetailRadius вокруг игрока,
+/// каждое следующее вдвое дальше, последнее - до края карты
+/// </summary>
+void World::SetupDetailLevels() {
+    m_detailRadius = m_config.GetDetailRadius();
+    m_detailRingByDistance.clear();
+    m_detailPeriods.clear();
+    m_detailFocusX = m_width / 2;
+    m_detailFocusY = m_height / 2;
+    if (!IsDetailEnabled()) return;
+
+    int rings = m_config.GetDetailRings();
+    m_detailPeriods.assign(rings + 1, 1);
+    for (int ring = 1; ring <= rings; ring++) {
+        m_detailPeriods[ring] = m_detailPeriods[ring - 1] * m_config.GetDetailInterval();
+    }
+
+    m_detailRingByDistance.resize(std::max(m_width, m_height));
+    for (int distance = 0; distance < static_cast<int>(m_detailRingByDistance.size()); distance++) {
+        int ring = 0;
+        long long reach = m_detailRadius;
+        while (ring < rings && distance > reach) {
+            ring++;
+            reach *= 2;
+        }
+        m_detailRingByDistance[distance] = static_cast<std::uint8_t>(ring);
+    }
+
+    Logger::Log("Automaton detail levels: every generation within " + std::to_string(m_detailRadius) +
+        " cells of the player, " + std::to_string(rings) + " outer rings, ring k every " +
+        std::to_string(m_config.GetDetailInterval()) + "^k generations");
+}
+
+/// <summary>
+/// Какие кольца обновляются в строке y в этом поколении. Полосы строк высотой в радиус детализации
+/// сдвинуты по фазе, чтобы внешние кольца считались понемногу каждое поколение, а не все сразу.
+/// Возвращает, есть ли в строке хоть одна обновляемая клетка
+/// </summary>
+bool World::BuildDetailDueRings(int y, std::uint8_t* ringDue) const {
+    int rings = static_cast<int>(m_detailPeriods.size()) - 1;
+    long long phase = m_generation + y / m_detailRadius;
+    for (int ring = 0; ring <= rings; ring++) {
+        ringDue[ring] = phase % m_detailPeriods[ring] == 0;
+    }
+
+    bool anyDue = false;
+    for (int ring = m_detailRingByDistance[std::abs(y - m_detailCenterY)]; ring <= rings; ring++) {
+        anyDue = anyDue || ringDue[ring];
+    }
+    return anyDue;
+}
+
+/// <summary>
+/// Активные клетки: изменившиеся в прошлом поколении, расширенные на радиус окрестности
+/// (сначала по строкам скользящим окном, затем по столбцам объединением строк)
+/// </summary>
+void World::BuildActiveFrontier() {
+    DilateChangedRows(1, m_height - 1);
+    m_activeCellCount = 0;
+    MarkActiveRows(1, m_height - 1);
+}
+
+/// <summary>
+/// Расширение изменившихся клеток строк [firstRow, lastRow) на радиус окрестности по горизонтали
+/// </summary>
+void World::DilateChangedRows(int firstRow, int lastRow) {
+    // Квадрат радиуса окрестности покрывает любую форму
+    int radius = m_neighborShape.GetRadius();
+    size_t width = static_cast<size_t>(m_width);
+
+    for (int y = firstRow; y < lastRow; y++) {
+        if (!m_rowChanged[y]) continue;
+
+        const std::uint8_t* changedRow = m_changedCells.data() + y * width;
+        std::uint8_t* dilatedRow = m_dilatedRows.data() + y * width;
+        int windowCount = 0;
+        for (int x = 0; x < std::min(radius, m_width); x++) {
+            windowCount += changedRow[x];
+        }
+        for (int x = 0; x < m_width; x++) {
+            if (x + radius < m_width) windowCount += changedRow[x + radius];
+            if (x - radius - 1 >= 0) windowCount -= changedRow[x - radius - 1];
+            dilatedRow[x] = windowCount > 0;
+        }
+    }
+}
+
+/// <summary>
+/// Активные клетки строк [firstRow, lastRow) - объединение расширенных строк в радиусе окрестности
+/// (DilateChangedRows для всех строк уже выполнен); число активных клеток добавляется к m_activeCellCount
+/// </summary>
+void World::MarkActiveRows(int firstRow, int lastRow) {
+    int radius = m_neighborShape.GetRadius();
+    size_t width = static_cast<size_t>(m_width);
+
+    for (int y = firstRow; y < lastRow; y++) {
+        std::uint8_t* activeRow = m_activeCells.data() + y * width;
+        int firstSource = std::max(1, y - radius);
+        int lastSource = std::min(m_height - 2, y + radius);
+        bool rowActive = false;
+
+        for (int sourceY = firstSource; sourceY <= lastSource; sourceY++) {
+            if (!m_rowChanged[sourceY]) continue;
+
+            const std::uint8_t* dilatedRow = m_dilatedRows.data() + sourceY * width;
+            if (!rowActive) {
+                std::copy(dilatedRow, dilatedRow + width, activeRow);
+                rowActive = true;
+            }
+            else {
+                for (size_t x = 0; x < width; x++) {
+                    activeRow[x] |= dilatedRow[x];
+                }
+            }
+        }
+
+        m_rowActive[y] = rowActive;
+        if (rowActive) {
+            m_activeCellCount += std::count(activeRow + 1, activeRow + m_width - 1, static_cast<std::uint8_t>(1));
+        }
+    }
+}
+
+/// <summary>
+/// Выбирает способ подсчета соседей на весь проход: для квадрата большого радиуса и достаточного
+/// числа запрашиваемых клеток строит префиксные суммы, если они укладываются в AreaTableLimitKB.
+/// smoothing - считать слоты сглаживания (BuildSmoothingSlots), а не тайлы, которые читают правила автомата
+/// </summary>
+void World::PrepareNeighborCounting(const TileGrid& currentMap, long long queryCount, bool smoothing) {
+    m_smoothingPass = smoothing;
+    int slotCount = smoothing ? m_smoothingSlotCount : m_countedSlotCount;
+    int areaRadius = m_neighborShape.IsSquare() ? m_neighborShape.GetRadius() : 0;
+    // С кольцами детализации большая часть активных клеток ждет очереди своего кольца - префиксные суммы
+    // по всей карте окупаются редко
+    bool fewQueries = IsDetailEnabled() && !smoothing;
+    m_useAreaCounts = !fewQueries && SummedAreaCounter::IsWorthwhile(areaRadius, slotCount, queryCount, m_width, m_height,
+        GetAreaTableLimitBytes());
+
+    if (m_useAreaCounts) {
+        m_areaCounter.Build(currentMap, smoothing ? m_smoothingSlotByTileId : m_countedSlotByTileId, slotCount);
+    }
+}
+
+/// <summary>
+/// Таблица ID -> слот для сглаживания: тайлы слотов slots (из m_slotByTileId) получают плотные номера
+/// 0..m_smoothingSlotCount - 1, остальные копятся в HaloSlot. slots переписываются новыми номерами
+/// </summary>
+void World::BuildSmoothingSlots(NeighborCounts::Slot* slots, int count) {
+    std::array<NeighborCounts::Slot, NeighborCounts::MaxSlots> smoothingSlotBySlot;
+    smoothingSlotBySlot.fill(NeighborCounts::HaloSlot);
+    m_smoothingSlotCount = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (slots[i] >= NeighborCounts::MaxTileSlots) continue; // NoSlot так и читается нулем
+
+        NeighborCounts::Slot& slot = smoothingSlotBySlot[slots[i]];
+        if (slot == NeighborCounts::HaloSlot) {
+            slot = static_cast<NeighborCounts::Slot>(m_smoothingSlotCount++);
+        }
+        slots[i] = slot;
+    }
+
+    m_smoothingSlotByTileId.resize(m_slotByTileId.size());
+    for (size_t tileId = 0; tileId < m_slotByTileId.size(); tileId++) {
+        m_smoothingSlotByTileId[tileId] = smoothingSlotBySlot[m_slotByTileId[tileId]];
+    }
+}
+
+/// <summary>
+/// Вызывает func со счетчиком соседей countNeighbors(x, y, counts), выбранным на весь проход:
+/// префиксные суммы или ядро формы окрестности. Граница и ореол карты хранят SentinelId
+/// со слотом HaloSlot, поэтому проверок границ на каждого соседа нет (радиус <= ореол + 1)
+/// </summary>
+template <typename Cell, typename Func>
+void World::DispatchNeighborCounter(const TileGrid& currentMap, Func&& func) const {
+    const NeighborCounts::Slot* slotByTileId = m_smoothingPass ? m_smoothingSlotByTileId.data() : m_countedSlotByTileId.data();
+    int slotCount = m_smoothingPass ? m_smoothingSlotCount : m_countedSlotCount;
+
+    if (m_useAreaCounts) {
+        int radius = m_neighborShape.GetRadius();
+        func([&](int x, int y, NeighborCounts& counts) {
+            m_areaCounter.Count(x, y, radius, slotByTileId[currentMap.Row<Cell>(y)[x]], counts);
+        });
+        return;
+    }
+
+    m_neighborShape.Dispatch(currentMap.GetStride(), [&](const auto& kernel) {
+        func([&](int x, int y, NeighborCounts& counts) {
+            counts.Clear(slotCount);
+            kernel.Count(currentMap.Row<Cell>(y) + x, slotByTileId, counts);
+        });
+    });
+}
+
+/// <summary>
+/// Назначает каждому символу тайла плотный слот NeighborCounts и строит таблицу ID -> слот.
+/// Символы, соседей которых читают правила, получают первые слоты 0..m_countedSlotCount - 1:
+/// шаг автомата считает только их, остальные тайлы копятся в HaloSlot вместе с ореолом.
+/// За ними до m_ruleSlotCount идут тайлы со своими правилами, последними - тайлы без правил
+/// </summary>
+void World::RebuildTileSlots() {
+    m_slotByChar.fill(NeighborCounts::NoSlot);
+    m_slotCount = 0;
+
+    auto assignSlot = [this](char character) {
+        NeighborCounts::Slot& slot = m_slotByChar[static_cast<unsigned char>(character)];
+        if (slot == NeighborCounts::NoSlot && m_slotCount < NeighborCounts::MaxTileSlots) {
+            slot = static_cast<NeighborCounts::Slot>(m_slotCount++);
+        }
+        return slot;
+    };
+
+    std::vector<int> tileIds;
+    if (m_tileManager) {
+        for (const auto& pair : m_tileManager->GetAllTiles()) {
+            tileIds.push_back(pair.first);
+        }
+        std::sort(tileIds.begin(), tileIds.end());
+    }
+
+    // Неизвестные ID отображаются как '.' (см. GetTileCharacter), поэтому и считаются как '.'
+    char fallbackCharacter = GetTileCharacter(-1);
+    std::string referencedTiles = m_automatonConfig ? m_automatonConfig->GetReferencedTiles() : std::string();
+    // 0 - соседей тайла читают правила, 1 - у тайла есть свои правила, 2 - остальные
+    auto slotTier = [&](char character) {
+        if (referencedTiles.find(character) != std::string::npos) return 0;
+        return m_automatonConfig && m_automatonConfig->GetRule(character) ? 1 : 2;
+    };
+
+    for (int tier = 0; tier < 3; tier++) {
+        if (slotTier(fallbackCharacter) == tier) {
+            assignSlot(fallbackCharacter);
+        }
+        for (int tileId : tileIds) {
+            char character = GetTileCharacter(tileId);
+            if (slotTier(character) == tier) {
+                assignSlot(character);
+            }
+        }
+        if (tier == 0) {
+            m_countedSlotCount = m_slotCount;
+        }
+        else if (tier == 1) {
+            m_ruleSlotCount = m_slotCount;
+        }
+    }
+
+    int tableSize = m_map.GetSentinelId() + 1;
+    m_slotByTileId.assign(tableSize, GetCharacterSlot(fallbackCharacter));
+    m_slotByTileId[m_map.GetSentinelId()] = NeighborCounts::HaloSlot;
+    for (int tileId : tileIds) {
+        if (tileId >= 0 && tileId < tableSize) {
+            m_slotByTileId[tileId] = GetCharacterSlot(GetTileCharacter(tileId));
+        }
+    }
+
+    m_countedSlotByTileId = m_slotByTileId;
+    for (NeighborCounts::Slot& slot : m_countedSlotByTileId) {
+        if (slot >= m_countedSlotCount) {
+            slot = NeighborCounts::HaloSlot;
+        }
+    }
+
+    m_rulesBindingDirty = true;
+}
+
+/// <summary>
+/// Привязывает правила автомата к слотам, если правила или набор тайлов изменились
+/// </summary>
+void World::EnsureRulesBound() {
+    if (!m_automatonConfig) return;
+
+    if (m_rulesBindingDirty || m_boundRulesRevision != m_automatonConfig->GetRevision()) {
+        // Порядок слотов зависит от того, какие тайлы читают правила
+        RebuildTileSlots();
+        m_automatonConfig->BindTileSlots(m_slotByChar);
+        m_boundRulesRevision = m_automatonConfig->GetRevision();
+        m_rulesBindingDirty = false;
+        m_automatonFullUpdate = true;
+        BuildRuleLookup();
+
+        // Битовые плоскости вычисляют правила сразу для 64 клеток, таблица исходов им не нужна
+        m_useBitplaneKernel = SelectBitplaneKernel();
+        m_useOutcomeTable = false;
+        if (m_useBitplaneKernel) {
+            Logger::Log("Automaton kernel: bitplanes (" + std::to_string(m_ruleSlotCount) + " of " +
+                std::to_string(m_slotCount) + " tile slots)");
+        }
+        else {
+            Logger::Log("Automaton kernel: per cell, counting " + std::to_string(m_countedSlotCount) + " of " +
+                std::to_string(m_slotCount) + " tile slots");
+            RebuildOutcomeTable();
+        }
+    }
+}
+
+/// <summary>
+/// Строит таблицу исходов правил для текущей окрестности, если она укладывается в RuleTableLimitKB,
+/// иначе шаг автомата вычисляет правила для каждой клетки
+/// </summary>
+void World::RebuildOutcomeTable() {
+    // Исход вероятностных правил зависит не только от соседей
+    if (m_automatonConfig->IsStochastic()) {
+        Logger::Log("Rule outcome table disabled: stochastic rules are evaluated per cell");
+        return;
+    }
+
+    int maxNeighborCount = m_neighborShape.GetNeighborCount();
+    size_t memoryLimitBytes = static_cast<size_t>(std::max(0, m_config.GetRuleTableLimitKB())) * 1024;
+
+    m_useOutcomeTable = m_automatonConfig->BuildOutcomeTable(m_slotByChar, maxNeighborCount, memoryLimitBytes);
+    if (!m_useOutcomeTable) {
+        Logger::Log("Rule outcome table exceeds RuleTableLimitKB=" + std::to_string(m_config.GetRuleTableLimitKB()) +
+            ", evaluating rules per cell");
+        return;
+    }
+
+    const RuleOutcomeTable& table = m_automatonConfig->GetOutcomeTable();
+    m_outcomeTileIds.assign(RuleOutcomeTable::FirstBirth + table.birthTiles.size(), 0);
+    for (size_t i = 0; i < table.birthTiles.size(); i++) {
+        int tileId = FindTileIdByCharacter(table.birthTiles[i]);
+        if (tileId == -1) {
+            // Слот без тайла (символ '.' по умолчанию) - рождение пропускается, таблица так не умеет
+            m_useOutcomeTable = false;
+            Logger::Log("Rule outcome table disabled: no tile for '" + std::string(1, table.birthTiles[i]) + "'");
+            return;
+        }
+        m_outcomeTileIds[RuleOutcomeTable::FirstBirth + i] = tileId;
+    }
+
+    // Состояние клетки в таблице: 0 - пустая, иначе по слоту тайла; тайлы без правил делят одно состояние
+    std::array<std::uint16_t, NeighborCounts::MaxSlots> stateBySlot;
+    stateBySlot.fill(static_cast<std::uint16_t>(table.GetNoRuleState()));
+    for (size_t i = 0; i < table.stateTiles.size(); i++) {
+        stateBySlot[GetCharacterSlot(table.stateTiles[i])] = static_cast<std::uint16_t>(i + 1);
+    }
+    m_outcomeStateByTileId.resize(m_slotByTileId.size());
+    for (size_t tileId = 0; tileId < m_slotByTileId.size(); tileId++) {
+        m_outcomeStateByTileId[tileId] = tileId == 0 ? 0 : stateBySlot[m_slotByTileId[tileId]];
+    }
+
+    Logger::Log("Rule outcome table: " + std::to_string(table.GetMemoryBytes() / 1024) + " KB, " +
+        std::to_string(table.slots.size()) + " counted tiles, " + std::to_string(table.stateTiles.size()) +
+        " tiles with rules, up to " + std::to_string(maxNeighborCount) + " neighbors");
+}
+
+/// <summary>
+/// Возвращение ID тайла в игровых координатах (без учета границы)
+/// </summary>
+/// <param name="x"></param>
+/// <param name="y"></param>
+/// <returns></returns>
+int World::GetTileAt(int x, int y) const {
+    // Координаты передаются для игровой области (0,0 - левый верхний угол игрового пространства)
+    int mapX = x + 1;
+    int mapY = y + 1;
+
+    return GetTileAtFullMap(mapX, mapY);
+}
+
+/// <summary>
+/// Преобразование ID тайла в символ для отображения
+/// </summary>
+char World::GetTileCharacter(int tileId) const {
+    if (!m_tileManager) return TilePalette::UnknownCharacter;
+    return m_tileManager->GetPalette().GetCharacter(tileId);
+}
+
+/// <summary>
+/// Находит ID тайла по его символу
+/// </summary>
+int World::FindTileIdByCharacter(char character) const {
+    if (!m_tileManager) return TilePalette::NoTile;
+    return m_tileManager->GetPalette().GetTileId(character);
+}
+
+/// <summary>
+/// Обновление внешнего вида всех тайлов после изменений конфигураций
+/// </summary>
+void World::UpdateTileAppearance() {
+    std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
+    if (!m_tileManager) return;
+
+    Logger::Log("Updating tile appearances...");
+    int changes = 0;
+
+    // Слоты и ширина ячеек m_nextMap меняются - недосчитанное поколение не продолжить
+    AbandonChunkedGeneration();
+
+    // Новые ID после перезагрузки могут не помещаться в узкую ячейку
+    m_map.EnsureCapacity(m_tileManager->GetMaxTileId());
+    m_nextMap.EnsureCapacity(m_tileManager->GetMaxTileId());
+    RebuildTileSlots();
+    m_automatonFullUpdate = true;
+
+    const TilePalette& palette = m_tileManager->GetPalette();
+
+    for (int y = 1; y < m_height - 1; y++) {
+        for (int x = 1; x < m_width - 1; x++) {
+            int tileId = m_map.Get(x, y);
+            const TileType* tile = palette.GetTile(tileId);
+
+            if (!tile) {
+                m_map.Set(x, y, GetTileCharacter(0));
+                changes++;
+            }
+        }
+    }
+
+    if (changes > 0) {
+        Logger::Log("Updated " + std::to_string(changes) + " tile appearances");
+    }
+    PublishSnapshot();
+}
+
+/// <summary>
+/// Замена удаленных тайлов на тайлы по умолчанию
+/// </summary>
+void World::RemoveDeletedTiles(const std::unordered_set<int>& removedTileIds) {
+    if (removedTileIds.empty()) return;
+
+    std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
 
     Logger::Log("Removing deleted tiles from world...");
     int replacements = 0;
 
     for (int y = 1; y < m_height - 1; y++) {
         for (int x = 1; x < m_width - 1; x++) {
-            if (removedTileIds.find(m_map[y][x]) != removedTileIds.end()) {
-                m_map[y][x] = GetTileCharacter(0);
+            if (removedTileIds.find(m_map.Get(x, y)) != removedTileIds.end()) {
+                m_map.Set(x, y, GetTileCharacter(0));
                 replacements++;
             }
         }
     }
 
     if (replacements > 0) {
+        AbandonChunkedGeneration();
+        m_automatonFullUpdate = true;
         Logger::Log("Replaced " + std::to_string(replacements) + " deleted tiles with grass");
+        PublishSnapshot();
     }
 }
 
@@ -686,7 +2473,7 @@ int World::GetRandomPassablePosition(int& outX, int& outY) {
         int y = disY(gen);
 
         int tileId = GetTileAt(x, y);
-        TileType* tile = m_tileManager->GetTileType(tileId);
+        const TileType* tile = m_tileManager->GetPalette().GetTile(tileId);
 
         if (tile && tile->IsPassable()) {
             outX = x;
@@ -1,27 +1,52 @@
 #pragma once
 #include <vector>
+#include <algorithm>
+#include <deque>
 #include <string>
 #include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "FastNoiseLite.h"
 #include "WorldConfig.h"
 #include "CellularAutomatonRules.h"
 #include "TileTypeManager.h"
 #include "FoodManager.h"
+#include "TileGrid.h"
+#include "NeighborCounts.h"
+#include "SummedAreaCounter.h"
+#include "ThreadPool.h"
 
 struct FoodSpawn {
     int x, y;
     int foodId;
 };
 
+/// <summary>
+/// Неизменяемый снимок карты после поколения generation (с границей, как в World::GetTileAtFullMap)
+/// </summary>
+struct WorldSnapshot {
+    TileGrid grid;
+    long long generation = 0;
+};
+
 class World {
 public:
-    // Конструктор
+    // Конструктор, деструктор
     World();
+    ~World();
 
     // Публичные методы
     void GenerateFromConfig();
     void UpdateTileAppearance();
+    void ReloadSpawnRules();
     void UpdateCellularAutomaton();
+    void StepAutomaton(int generations);
+    void RequestGenerations(int generations);
+    void ContinueGeneration();
+    std::unique_lock<std::recursive_mutex> PauseAutomaton() { return std::unique_lock<std::recursive_mutex>(m_automatonMutex); }
     void RemoveDeletedTiles(const std::unordered_set<int>& removedTileIds);
     void SpawnRandomFood(int count = 10);
     void RespawnFoodPeriodically();
@@ -35,14 +60,19 @@ public:
     int GetTotalWidth() const { return m_width; }
     int GetTotalHeight() const { return m_height; }
     int GetTileAtFullMap(int x, int y) const {
-        if (x >= 0 && x < m_width && y >= 0 && y < m_height) {
-            return m_map[y][x];
+        std::shared_ptr<const WorldSnapshot> snapshot = GetSnapshot();
+        if (!snapshot || !snapshot->grid.InBounds(x, y)) {
+            return 0;
+        }
+        if (x == 0 || y == 0 || x == snapshot->grid.GetWidth() - 1 || y == snapshot->grid.GetHeight() - 1) {
+            return m_borderTileId; // в самой сетке граница хранит SentinelId
         }
-        return 0;
+        return snapshot->grid.Get(x, y);
     }
     int GetCurrentSeed() const { return m_config.GetEffectiveSeed(); }
     bool IsAutomatonEnabled() const { return m_automatonEnabled; }
     const Food* GetFoodAt(int x, int y) const;
+    std::shared_ptr<const WorldSnapshot> GetSnapshot() const { return std::atomic_load(&m_snapshot); }
     CellularAutomatonConfig* GetAutomatonConfig() const {
         return m_automatonConfig;
     }
@@ -51,41 +81,278 @@ public:
     void SetTileManager(TileTypeManager* tileManager) { m_tileManager = tileManager; }
     void SetFoodManager(FoodManager* foodManager) { m_foodManager = foodManager; }
     void SetAutomatonEnabled(bool enabled) { m_automatonEnabled = enabled; }
+    void SetDetailFocus(int x, int y) {
+        // Координаты игровой области, как в GetTileAt
+        m_detailFocusX = x + 1;
+        m_detailFocusY = y + 1;
+    }
     void SetAutomatonConfig(CellularAutomatonConfig* config) {
+        std::lock_guard<std::recursive_mutex> lock(m_automatonMutex);
         m_automatonConfig = config;
+        m_rulesBindingDirty = true;
+        AbandonChunkedGeneration();
     }
     bool RemoveFoodAt(int x, int y);
 
 private:
+    // Отладочные инструменты: tools/BitplaneCheck подменяет форму окрестности и выбор ядра,
+    // tools/NeighborBench читает карту и слоты тайлов
+    friend class BitplaneKernelCheck;
+    friend class NeighborCountingBench;
+
+    // Константы
+    static constexpr int BandsPerThread = 4;
+    static constexpr int MaxLoggedNaturalDeaths = 3;
+    static constexpr int SurvivalRuleStream = 0;   // потоки случайных чисел клетки: по одному на правило
+    static constexpr int DeathRuleStream = 1;
+    static constexpr int FirstBirthRuleStream = 2; // + индекс правила рождения
+    static constexpr int MaxBitplaneSlots = 8;
+    static constexpr int MaxBitplaneRadius = 4;
+    static constexpr int MaxCountBits = 7;      // (2 * 4 + 1)^2 = 81 < 2^7
+    static constexpr int MaxRowSumBits = 4;     // 2 * 4 + 1 = 9 < 2^4
+    static constexpr int MaxCyclePeriod = 16;   // длина истории хешей поколений
+    static constexpr int MaxBlockGenerations = 8;
+    static constexpr int BlockTileBytes = 256 * 1024; // оба буфера тайла должны остаться в L2
+    static constexpr int MaxPendingGenerations = 16;  // очередь запросов фонового потока
+    static constexpr size_t SnapshotPoolSize = 3;     // опубликованный снимок, снимок у читателя и запасной
+
+    // Приватные структуры
+    struct AutomatonStepStats {
+        struct LoggedDeath {
+            int x, y;
+            char tile;
+        };
+
+        int births = 0;
+        int deaths = 0;
+        int naturalDeaths = 0;
+        LoggedDeath loggedNaturalDeaths[MaxLoggedNaturalDeaths];
+    };
+
+    // Поля генерации по клеткам карты без границы (строка за строкой). Зависят только от сида,
+    // частоты шума и размера, поэтому новые правила спавна или повторная генерация их не пересчитывают
+    struct TerrainLayers {
+        int columns = 0;
+        int rows = 0;
+        int seed = 0;
+        float frequency = 0.0f;
+        std::vector<float> heights;            // высота 0..1 из трех слоев шума
+        std::vector<std::uint8_t> zones;       // 0 - низины, 1 - равнины, 2 - горы
+        std::vector<float> selectionNoise;     // шум выбора тайла в зоне, 0..1
+    };
+
+    // Таблица зоны высот (WorldConfig::GetSpawnZoneTables) с ID тайлов вместо символов
+    struct ZoneTileTable {
+        std::vector<int> tileIds;       // -1 - у символа нет тайла
+        std::vector<float> cumulative;
+        float totalWeight = 0.0f;
+        int fallbackTileId = -1;
+    };
+
+    // Буферы тайла блочного шага: свои у каждой дорожки пула, выделяются один раз под GetBlockTileSide()
+    struct BlockScratch {
+        TileGrid source;
+        TileGrid target;
+    };
+
+    // Фазы поколения по частям: каждая, кроме фиксации, идет по строкам 1..height-2
+    enum class ChunkedPhase { Dilate, Activate, Planes, Rows, Commit };
+
     // Приватные методы
     void GenerateBaseTerrain();
+    bool HasTerrainLayers() const;
+    void BuildTerrainLayers();
+    void ApplyZoneTiles();
     void CreateBorder();
     void SmoothTerrain();
     char GetTileCharacter(int tileId) const;
     int FindTileIdByCharacter(char character) const;
-    std::unordered_map<char, int> CountNeighbors(int x, int y, const std::vector<std::vector<int>>& currentMap) const;
-    char SelectTileByZone(int zone, const std::unordered_map<char, SpawnRule>& spawnRules, int x, int y);
+    void PrepareNeighborCounting(const TileGrid& currentMap, long long queryCount, bool smoothing);
+    void BuildSmoothingSlots(NeighborCounts::Slot* slots, int count);
+    template <typename Cell, typename Func>
+    void DispatchNeighborCounter(const TileGrid& currentMap, Func&& func) const;
+    void BuildZoneTileTables();
+    int SelectTileByZone(int zone, float noise) const;
     char FindWaterTile(const std::unordered_map<char, SpawnRule>& spawnRules) const;
     char FindGrassTile(const std::unordered_map<char, SpawnRule>& spawnRules) const;
     char FindMountainTile(const std::unordered_map<char, SpawnRule>& spawnRules) const;
-    char FindTileByTerrainType(const std::string& terrainType, const std::unordered_map<char, SpawnRule>& spawnRules) const;
+    char FindTileByTerrainType(TerrainRole role, const std::unordered_map<char, SpawnRule>& spawnRules) const;
     bool CanSpawnFoodAt(int x, int y) const;
     int GetRandomPassablePosition(int& outX, int& outY);
-    void CheckNeighbor(int x, int y, int dx, int dy,
-        const std::vector<std::vector<int>>& currentMap,
-        std::unordered_map<char, int>& counts) const;
+    bool BeginAutomatonUpdate();
+    bool AdvanceGeneration(AutomatonStepStats& stats);
+    bool BeginGeneration(bool& fullUpdate);
+    void FinishGeneration(const AutomatonStepStats& stats, bool fullUpdate);
+    void LogGeneration(const AutomatonStepStats& stats, bool computed) const;
+    void EnterChunkedPhase(ChunkedPhase phase);
+    void AbandonChunkedGeneration();
+    AutomatonStepStats RunAutomatonStep(const TileGrid& currentMap, TileGrid& newMap);
+    void PrepareAutomatonStep(const TileGrid& currentMap);
+    void RunAutomatonRows(int firstRow, int lastRow, const TileGrid& currentMap, TileGrid& newMap,
+        AutomatonStepStats& total);
+    template <typename Func>
+    void ForEachRowBand(int firstRow, int lastRow, Func&& func);
+    void StepAutomatonRows(int firstRow, int lastRow, const TileGrid& currentMap, TileGrid& newMap,
+        AutomatonStepStats& stats);
+    template <typename Cell>
+    Cell EvaluateCell(int x, int y, int tileId, const NeighborCounts& neighborCounts, AutomatonStepStats& stats) const;
+    bool RuleFires(const RuleParser& rule, const NeighborCounts& neighborCounts, int x, int y, int stream) const;
+    int SelectBlockDepth(int remainingGenerations) const;
+    int GetBlockTileSide() const;
+    AutomatonStepStats RunBlockedGenerations(int depth, int& lastGenerationChanges);
+    void PrepareBlockScratch(int laneCount, int side);
+    void StepAutomatonTile(int firstX, int firstY, int lastX, int lastY, int depth, const TileGrid& currentMap,
+        TileGrid& newMap, BlockScratch& scratch, AutomatonStepStats& stats, int& lastGenerationChanges) const;
+    bool SelectBitplaneKernel();
+    void PrepareBitplanes();
+    void BuildBitplaneRows(int firstRow, int lastRow, const TileGrid& currentMap);
+    void StepBitplaneRows(int firstRow, int lastRow, const TileGrid& currentMap, TileGrid& newMap,
+        AutomatonStepStats& stats);
+    std::uint64_t EvaluateRuleBits(const RuleParser& rule, const std::uint64_t* slotCounts) const;
+    void ResetActiveFrontier();
+    void SetupDetailLevels();
+    bool BuildDetailDueRings(int y, std::uint8_t* ringDue) const;
+    void BuildActiveFrontier();
+    void DilateChangedRows(int firstRow, int lastRow);
+    void MarkActiveRows(int firstRow, int lastRow);
+    void RebuildTileSlots();
+    void EnsureRulesBound();
+    void BuildRuleLookup();
+    void RebuildOutcomeTable();
+    void UpdateGridHash(bool allRows);
+    void TrackCycle();
+    void ReplayCycle();
+    void ResetCycleDetection();
+    void PublishSnapshot();
+    void AutomatonWorkerLoop();
+    void StopAutomatonWorker();
+    bool IsDetailEnabled() const { return m_detailRadius > 0; }
+    bool HasStochasticRules() const { return m_automatonConfig && m_automatonConfig->IsStochastic(); }
+    int GetRowBandCount(int rows) const { return std::max(1, std::min(rows, m_threadPool.GetThreadCount() * BandsPerThread)); }
+    int GetBitplaneRadius() const { return m_neighborShape.IsSquare() ? m_neighborShape.GetRadius() : 0; }
+    NeighborCounts::Slot GetCharacterSlot(char character) const {
+        return m_slotByChar[static_cast<unsigned char>(character)];
+    }
+    size_t GetAreaTableLimitBytes() const { return static_cast<size_t>(std::max(0, m_config.GetAreaTableLimitKB())) * 1024; }
 
     // Приватные поля
-    std::vector<std::vector<int>> m_map;
+    TileGrid m_map;
+    TileGrid m_nextMap; // буфер следующего поколения (пинг-понг с m_map)
     int m_width;
     int m_height;
     int m_contentWidth;
     int m_contentHeight;
     FastNoiseLite m_noiseGenerator;
+    TerrainLayers m_terrainLayers;
+    std::vector<ZoneTileTable> m_zoneTileTables;
     WorldConfig m_config;
     bool m_automatonEnabled;
     TileTypeManager* m_tileManager;
     FoodManager* m_foodManager;
     std::unordered_map<int, FoodSpawn> m_foodSpawns;
     CellularAutomatonConfig* m_automatonConfig;
+    int m_borderTileId; // тайл, которым отображается кольцо границы
+    NeighborShape m_neighborShape; // окрестность клетки из NeighborShape/NeighborRadius/NeighborMask
+
+    // Плотные индексы тайлов для NeighborCounts (один слот на символ).
+    // Шаг автомата считает только первые m_countedSlotCount слотов - тайлы, которые читают правила;
+    // битовые плоскости строятся для первых m_ruleSlotCount слотов - еще и тайлов со своими правилами
+    std::vector<NeighborCounts::Slot> m_slotByTileId;
+    std::vector<NeighborCounts::Slot> m_countedSlotByTileId; // остальные тайлы -> HaloSlot
+    std::array<NeighborCounts::Slot, 256> m_slotByChar;
+    int m_slotCount;
+    int m_countedSlotCount;
+    int m_ruleSlotCount;
+    bool m_smoothingPass; // проход PrepareNeighborCounting - сглаживание: считаются только слоты сглаживания
+    std::vector<NeighborCounts::Slot> m_smoothingSlotByTileId; // вода, трава, горы -> 0..2, остальные -> HaloSlot
+    int m_smoothingSlotCount;
+    bool m_rulesBindingDirty;
+    int m_boundRulesRevision;
+
+    // Таблица исходов правил (CellularAutomatonConfig::BuildOutcomeTable) и ID тайлов для каждого исхода
+    bool m_useOutcomeTable;
+    std::vector<int> m_outcomeTileIds;
+    std::vector<std::uint16_t> m_outcomeStateByTileId;
+
+    // Битовые плоскости: 64 клетки в слове, счетчики соседей в бит-срезах (для малого числа тайлов)
+    bool m_useBitplaneKernel;
+    int m_wordsPerRow;
+    int m_countBits;
+    int m_rowSumBits;
+    std::vector<std::uint64_t> m_tilePlanes;    // [слот][строка][слово]
+    std::vector<std::uint64_t> m_emptyPlane;    // [строка][слово] - клетки с ID 0
+    std::vector<std::uint64_t> m_rowSumPlanes;  // [слот][строка][разряд][слово] - суммы по строке
+    std::vector<std::uint8_t> m_planeRowNeeded;
+    std::vector<NeighborCounts::Slot> m_countedSlots;
+
+    // Правила по слоту тайла и правила рождения в порядке проверки (BuildRuleLookup)
+    std::vector<const CellRule*> m_ruleBySlot;
+    std::vector<const RuleParser*> m_birthRules;
+    std::vector<int> m_birthTileIds;
+    std::uint64_t m_ruleRandomKey; // ключ случайных чисел вероятностных правил, из сида мира
+
+    // Подсчет соседей через префиксные суммы для больших радиусов
+    SummedAreaCounter m_areaCounter;
+    bool m_useAreaCounts;
+
+    // Параллельный шаг автомата по полосам строк
+    ThreadPool m_threadPool;
+    std::vector<AutomatonStepStats> m_bandStats;
+    std::vector<BlockScratch> m_blockScratch;
+
+    // Инкрементальный шаг: клетки, изменившиеся в прошлом поколении, и квадрат радиуса окрестности вокруг них
+    std::vector<std::uint8_t> m_changedCells;
+    std::vector<std::uint8_t> m_activeCells;
+    std::vector<std::uint8_t> m_dilatedRows;
+    std::vector<std::uint8_t> m_rowChanged;
+    std::vector<std::uint8_t> m_rowActive;
+    long long m_activeCellCount;
+    bool m_automatonFullUpdate; // пересчитать все клетки (генерация, перезагрузка правил или тайлов)
+
+    // Уровни детализации (AutomatonDetailRadius > 0): в радиусе от игрока клетки считаются каждое поколение,
+    // кольцо k дальше - раз в interval^k поколений. Активная клетка, чье кольцо пропускает поколение,
+    // ждет в m_detailPendingCells и считается, когда до кольца дойдет очередь
+    int m_detailRadius;
+    std::vector<std::uint8_t> m_detailRingByDistance; // кольцо по чебышевскому расстоянию до центра
+    std::vector<long long> m_detailPeriods;           // через сколько поколений обновляется кольцо
+    std::vector<std::uint8_t> m_detailPendingCells;
+    std::vector<std::uint8_t> m_detailPendingRows;
+    std::atomic<int> m_detailFocusX;                  // игрок в координатах полной карты (пишет поток игры)
+    std::atomic<int> m_detailFocusY;
+    int m_detailCenterX;                              // центр колец текущего поколения
+    int m_detailCenterY;
+
+    // Неподвижное состояние и циклы: хеши строк, история хешей поколений и записанные состояния цикла
+    std::vector<std::uint64_t> m_rowHashes;
+    std::uint64_t m_gridHash;
+    std::deque<std::uint64_t> m_hashHistory;
+    std::vector<TileGrid> m_cycleStates;
+    int m_cyclePeriod;          // 0 - цикл не найден; иначе идет запись или повтор
+    bool m_cycleConfirmed;      // состояния записаны и проверены - поколения берутся из m_cycleStates
+    int m_cyclePosition;
+    long long m_skippedGenerations;
+
+    // Фоновый поток автомата: шаги под m_automatonMutex, читатели берут опубликованный снимок без блокировок.
+    // Потоки игры, меняющие карту или конфиги, держат m_automatonMutex (рекурсивный - методы World тоже его берут)
+    std::shared_ptr<const WorldSnapshot> m_snapshot;
+    long long m_generation;
+    std::vector<std::shared_ptr<WorldSnapshot>> m_snapshotPool; // буферы снимков: свободный (use_count() == 1) перезаписывается
+    size_t m_nextPooledSnapshot;                                // какой буфер заменить, если все заняты читателями
+    std::recursive_mutex m_automatonMutex;
+    std::thread m_automatonWorker;
+    std::mutex m_requestMutex;
+    std::condition_variable m_requestReady;
+    int m_pendingGenerations;
+    bool m_stopWorker;
+
+    // Поколение по частям в бюджете кадра (AutomatonFrameBudgetMs > 0): фоновый поток не запускается,
+    // ContinueGeneration проходит фазы поколения по строкам до m_chunkedNextRow и публикует поколение целиком
+    std::atomic<int> m_frameBudgetMs;
+    bool m_chunkedGenerationActive;
+    bool m_chunkedFullUpdate;
+    ChunkedPhase m_chunkedPhase;
+    int m_chunkedNextRow;
+    int m_chunkedFrames;
+    double m_chunkedStepMs;
+    AutomatonStepStats m_chunkedStats;
 };
\ No newline at end of file
@@ -6,7 +6,8 @@
 WorldConfig::WorldConfig()
     : m_width(80), m_height(40), m_seed(1337),
     m_useRandomSeed(true), m_noiseFrequency(0.7f),
-    m_neighborRadius(3),
+    m_neighborRadius(3), m_neighborShapeType(NeighborShapeType::Moore), m_automatonThreads(0), m_ruleTableLimitKB(1024),
+    m_areaTableLimitKB(65536), m_automatonFrameBudgetMs(0), m_detailRadius(0), m_detailRings(2), m_detailInterval(8),
     m_worldConfigPath("config/world_gen.cfg"),
     m_spawnConfigPath("config/world_spawn.cfg") {
 }
@@ -14,6 +15,8 @@ WorldConfig::WorldConfig()
 WorldConfig::WorldConfig(const std::string& worldConfigPath, const std::string& spawnConfigPath)
     : m_width(80), m_height(40), m_seed(1337),
     m_useRandomSeed(true), m_noiseFrequency(0.7f),
+    m_neighborRadius(3), m_neighborShapeType(NeighborShapeType::Moore), m_automatonThreads(0), m_ruleTableLimitKB(1024),
+    m_areaTableLimitKB(65536), m_automatonFrameBudgetMs(0), m_detailRadius(0), m_detailRings(2), m_detailInterval(8),
     m_worldConfigPath(worldConfigPath),
     m_spawnConfigPath(spawnConfigPath) {
 }
@@ -33,6 +36,10 @@ bool WorldConfig::LoadConfig() {
         return false;
     }
 
+    if (m_neighborShapeType == NeighborShapeType::Custom && m_neighborMask.empty()) {
+        Logger::Log("ERROR: NeighborShape=Custom requires NeighborMask");
+        return false;
+    }
 
     if (m_useRandomSeed) {
         m_seed = static_cast<int>(time(nullptr));
@@ -55,6 +62,16 @@ bool WorldConfig::LoadConfig() {
     return true;
 }
 
+/// <summary>
+/// Окрестность клетки для автомата: форма NeighborShape радиуса NeighborRadius или маска NeighborMask
+/// </summary>
+NeighborShape WorldConfig::GetNeighborShape() const {
+    if (m_neighborShapeType == NeighborShapeType::Custom && !m_neighborMask.empty()) {
+        return NeighborShape::FromOffsets(m_neighborMask);
+    }
+    return NeighborShape::Create(m_neighborShapeType, m_neighborRadius);
+}
+
 /// <summary>
 /// Обработка пары ключ-значение из основного конфига
 /// </summary>
@@ -77,6 +94,39 @@ bool WorldConfig::ParseKeyValue(const std::string& key, const std::string& value
     else if (key == "NeighborRadius") {
         m_neighborRadius = std::stoi(value);
     }
+    else if (key == "NeighborShape") {
+        if (!NeighborShape::ParseType(value, m_neighborShapeType)) {
+            Logger::Log("WARNING: Unknown neighbor shape: " + value);
+            return false;
+        }
+    }
+    else if (key == "NeighborMask") {
+        if (!NeighborShape::ParseMask(value, m_neighborMask)) {
+            Logger::Log("WARNING: Invalid neighbor mask (odd square of '0'/'1' rows separated by ','): " + value);
+            return false;
+        }
+    }
+    else if (key == "AutomatonThreads") {
+        m_automatonThreads = std::stoi(value);
+    }
+    else if (key == "RuleTableLimitKB") {
+        m_ruleTableLimitKB = std::stoi(value);
+    }
+    else if (key == "AreaTableLimitKB") {
+        m_areaTableLimitKB = std::stoi(value);
+    }
+    else if (key == "AutomatonFrameBudgetMs") {
+        m_automatonFrameBudgetMs = std::max(0, std::stoi(value));
+    }
+    else if (key == "AutomatonDetailRadius") {
+        m_detailRadius = std::max(0, std::stoi(value));
+    }
+    else if (key == "AutomatonDetailRings") {
+        m_detailRings = std::max(1, std::min(MaxDetailRings, std::stoi(value)));
+    }
+    else if (key == "AutomatonDetailInterval") {
+        m_detailInterval = std::max(2, std::min(MaxDetailInterval, std::stoi(value)));
+    }
     else {
         Logger::Log("WARNING: Unknown config key: " + key);
         return false;
@@ -85,6 +135,13 @@ bool WorldConfig::ParseKeyValue(const std::string& key, const std::string& value
     return true;
 }
 
+/// <summary>
+/// Перечитывает только правила спавна, не трогая размер, сид и остальные параметры мира
+/// </summary>
+bool WorldConfig::ReloadSpawnConfig() {
+    return ParseSpawnConfig();
+}
+
 /// <summary>
 /// Загрука и парсинг конфигурации спавна тайлов для разных зон высот
 /// </summary>
@@ -147,9 +204,41 @@ bool WorldConfig::ParseSpawnConfig() {
     }
 
     file.close();
+    BuildSpawnZoneTables();
     return true;
 }
 
+/// <summary>
+/// Таблицы нарастающих весов по зонам высот из правил спавна
+/// </summary>
+void WorldConfig::BuildSpawnZoneTables() {
+    size_t zoneCount = 0;
+    for (const auto& pair : m_spawnRules) {
+        zoneCount = std::max(zoneCount, pair.second.zoneProbabilities.size());
+    }
+
+    m_spawnZoneTables.assign(zoneCount, SpawnZoneTable());
+    for (size_t zone = 0; zone < zoneCount; zone++) {
+        SpawnZoneTable& table = m_spawnZoneTables[zone];
+        float totalWeight = 0.0f;
+        float fallbackWeight = -1.0f;
+
+        for (const auto& pair : m_spawnRules) {
+            if (pair.second.zoneProbabilities.size() <= zone) continue;
+
+            float weight = pair.second.zoneProbabilities[zone];
+            totalWeight += weight;
+            table.tiles.push_back(pair.first);
+            table.cumulative.push_back(totalWeight);
+
+            if (weight > fallbackWeight) {
+                fallbackWeight = weight;
+                table.fallbackTile = pair.first;
+            }
+        }
+    }
+}
+
 /// <summary>
 /// Возвращение сида для генерации (случайный или заданный)
 /// </summary>
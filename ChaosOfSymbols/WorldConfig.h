@@ -3,14 +3,20 @@
 #include <unordered_map>
 #include "ConfigParser.h"
 #include "SpawnRule.h"
+#include "NeighborShape.h"
 
 class WorldConfig : public ConfigParser {
 public:
+    // Константы
+    static constexpr int MaxDetailRings = 8;
+    static constexpr int MaxDetailInterval = 64; // 64^8 еще помещается в long long
+
     WorldConfig();
     WorldConfig(const std::string& worldConfigPath, const std::string& spawnConfigPath);
 
     // Пцбличные методы
     bool LoadConfig();
+    bool ReloadSpawnConfig();
 
     // Геттеры
     int GetWidth() const { return m_width; }
@@ -21,7 +27,17 @@ public:
     int GetEffectiveSeed() const;
     const SpawnRule* GetSpawnRule(char spawnTile) const;
     const std::unordered_map<char, SpawnRule>& GetAllSpawnRules() const { return m_spawnRules; }
+    const std::vector<SpawnZoneTable>& GetSpawnZoneTables() const { return m_spawnZoneTables; }
     int GetNeighborRadius() const { return m_neighborRadius; }
+    NeighborShapeType GetNeighborShapeType() const { return m_neighborShapeType; }
+    NeighborShape GetNeighborShape() const;
+    int GetAutomatonThreads() const { return m_automatonThreads; }
+    int GetRuleTableLimitKB() const { return m_ruleTableLimitKB; }
+    int GetAreaTableLimitKB() const { return m_areaTableLimitKB; }
+    int GetAutomatonFrameBudgetMs() const { return m_automatonFrameBudgetMs; }
+    int GetDetailRadius() const { return m_detailRadius; }
+    int GetDetailRings() const { return m_detailRings; }
+    int GetDetailInterval() const { return m_detailInterval; }
 
     // Сеттеры
     void SetWidth(int width) { m_width = width; }
@@ -32,10 +48,19 @@ public:
     void SetWorldConfigPath(const std::string& path) { m_worldConfigPath = path; }
     void SetSpawnConfigPath(const std::string& path) { m_spawnConfigPath = path; }
     void SetNeighborRadius(int radius) { m_neighborRadius = radius; }
+    void SetNeighborShapeType(NeighborShapeType type) { m_neighborShapeType = type; }
+    void SetAutomatonThreads(int threads) { m_automatonThreads = threads; }
+    void SetRuleTableLimitKB(int limitKB) { m_ruleTableLimitKB = limitKB; }
+    void SetAreaTableLimitKB(int limitKB) { m_areaTableLimitKB = limitKB; }
+    void SetAutomatonFrameBudgetMs(int budgetMs) { m_automatonFrameBudgetMs = budgetMs; }
+    void SetDetailRadius(int radius) { m_detailRadius = radius; }
+    void SetDetailRings(int rings) { m_detailRings = rings; }
+    void SetDetailInterval(int interval) { m_detailInterval = interval; }
 
 protected:
     bool ParseKeyValue(const std::string& key, const std::string& value) override;
     bool ParseSpawnConfig();
+    void BuildSpawnZoneTables();
 
 private:
     int m_width;
@@ -44,8 +69,18 @@ private:
     bool m_useRandomSeed;
     float m_noiseFrequency;
     int m_neighborRadius;
+    NeighborShapeType m_neighborShapeType;
+    std::vector<NeighborOffset> m_neighborMask; // смещения для NeighborShape=Custom
+    int m_automatonThreads; // 0 - по числу ядер
+    int m_ruleTableLimitKB; // 0 - без таблицы исходов
+    int m_areaTableLimitKB; // 0 - без префиксных сумм
+    int m_automatonFrameBudgetMs; // 0 - поколение целиком в фоновом потоке
+    int m_detailRadius;   // 0 - вся карта обновляется каждое поколение
+    int m_detailRings;
+    int m_detailInterval;
 
     std::unordered_map<char, SpawnRule> m_spawnRules;
+    std::vector<SpawnZoneTable> m_spawnZoneTables; // по зоне высот
 
     std::string m_worldConfigPath;
     std::string m_spawnConfigPath;
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "CellularAutomatonRules.h"
+#include "Logger.h"
+#include "TileTypeManager.h"
+#include "World.h"
+
+/// <summary>
+/// Случайная дифференциальная проверка ядра битовых плоскостей: шаг битовых плоскостей
+/// против шага по клеткам на случайных картах для всех допустимых радиусов (подробности в лог)
+/// </summary>
+class BitplaneKernelCheck {
+public:
+    static bool Run(World& world, int trials);
+};
+
+bool BitplaneKernelCheck::Run(World& world, int trials) {
+    std::lock_guard<std::recursive_mutex> lock(world.m_automatonMutex);
+    if (!world.m_tileManager || !world.m_automatonConfig || world.m_width <= 2 || world.m_height <= 2) return false;
+
+    world.AbandonChunkedGeneration();
+    world.EnsureRulesBound();
+    Logger::Log("=== BITPLANE KERNEL CHECK: " + std::to_string(trials) + " random maps ===");
+
+    std::vector<int> tileIds;
+    for (const auto& pair : world.m_tileManager->GetAllTiles()) {
+        tileIds.push_back(pair.first);
+    }
+    std::sort(tileIds.begin(), tileIds.end());
+    if (tileIds.empty()) return false;
+
+    // Эталон - вычисление правил по клеткам: таблица исходов построена только для текущего радиуса
+    NeighborShape savedShape = world.m_neighborShape;
+    bool savedOutcomeTable = world.m_useOutcomeTable;
+    world.m_useOutcomeTable = false;
+
+    std::mt19937 rng(static_cast<unsigned int>(world.m_config.GetEffectiveSeed()));
+    TileGrid randomMap = world.m_map;
+    randomMap.SetHalo(std::max(randomMap.GetHalo(), World::MaxBitplaneRadius));
+    TileGrid scalarMap = randomMap;
+    TileGrid bitplaneMap = randomMap;
+    int passed = 0;
+
+    for (int trial = 0; trial < trials; trial++) {
+        int radius = trial % (World::MaxBitplaneRadius + 1);
+        world.m_neighborShape = NeighborShape::Create(NeighborShapeType::Moore, radius);
+        if (!world.SelectBitplaneKernel()) {
+            Logger::Log("Current rules or tile set are not supported by the bitplane kernel");
+            break;
+        }
+
+        // У каждого тайла своя доля, чтобы счетчики покрывали весь диапазон
+        std::vector<int> weights(tileIds.size());
+        for (int& weight : weights) weight = static_cast<int>(rng() % 8);
+        weights[rng() % weights.size()]++;
+        std::discrete_distribution<int> pickTile(weights.begin(), weights.end());
+        for (int y = 1; y < world.m_height - 1; y++) {
+            for (int x = 1; x < world.m_width - 1; x++) {
+                randomMap.Set(x, y, tileIds[pickTile(rng)]);
+            }
+        }
+
+        world.ResetActiveFrontier();
+        world.m_automatonFullUpdate = true;
+        world.m_useBitplaneKernel = false;
+        World::AutomatonStepStats scalarStats = world.RunAutomatonStep(randomMap, scalarMap);
+        world.m_useBitplaneKernel = true;
+        World::AutomatonStepStats bitplaneStats = world.RunAutomatonStep(randomMap, bitplaneMap);
+
+        int mismatchX = -1;
+        int mismatchY = -1;
+        for (int y = 1; y < world.m_height - 1 && mismatchX < 0; y++) {
+            for (int x = 1; x < world.m_width - 1; x++) {
+                if (scalarMap.Get(x, y) != bitplaneMap.Get(x, y)) {
+                    mismatchX = x;
+                    mismatchY = y;
+                    break;
+                }
+            }
+        }
+
+        bool statsMatch = scalarStats.births == bitplaneStats.births && scalarStats.deaths == bitplaneStats.deaths &&
+            scalarStats.naturalDeaths == bitplaneStats.naturalDeaths;
+        if (mismatchX < 0 && statsMatch) {
+            passed++;
+        }
+        else if (mismatchX >= 0) {
+            Logger::Log("MISMATCH in trial " + std::to_string(trial) + " (radius " + std::to_string(radius) + ") at " +
+                std::to_string(mismatchX) + "," + std::to_string(mismatchY) + ": per cell " +
+                std::to_string(scalarMap.Get(mismatchX, mismatchY)) + ", bitplanes " +
+                std::to_string(bitplaneMap.Get(mismatchX, mismatchY)));
+        }
+        else {
+            Logger::Log("MISMATCH in trial " + std::to_string(trial) + " (radius " + std::to_string(radius) +
+                "): per cell " + std::to_string(scalarStats.births) + "/" + std::to_string(scalarStats.deaths) +
+                " births/deaths, bitplanes " + std::to_string(bitplaneStats.births) + "/" +
+                std::to_string(bitplaneStats.deaths));
+        }
+    }
+
+    world.m_neighborShape = savedShape;
+    world.m_useOutcomeTable = savedOutcomeTable;
+    world.m_useBitplaneKernel = world.SelectBitplaneKernel();
+    world.m_automatonFullUpdate = true;
+
+    Logger::Log("=== BITPLANE KERNEL CHECK: " + std::to_string(passed) + "/" + std::to_string(trials) + " trials match ===");
+    return passed == trials;
+}
+
+/// <summary>
+/// BitplaneCheck [trials]: генерирует мир по конфигам из config/ (запускать из каталога игры)
+/// и сверяет на нем ядро битовых плоскостей с вычислением по клеткам
+/// </summary>
+int main(int argc, char* argv[]) {
+    int trials = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    Logger::Initialize("BitplaneCheck.log");
+
+    TileTypeManager tileManager;
+    CellularAutomatonConfig automatonConfig;
+    if (!tileManager.LoadFromFile() || !automatonConfig.LoadFromFile("config/cellular_automaton.cfg")) {
+        std::cerr << "BitplaneCheck: failed to load configs from config/" << std::endl;
+        Logger::Close();
+        return 1;
+    }
+
+    World world;
+    world.SetTileManager(&tileManager);
+    world.SetAutomatonConfig(&automatonConfig);
+    world.GenerateFromConfig();
+
+    bool passed = BitplaneKernelCheck::Run(world, trials);
+    std::cout << "BitplaneCheck: " << (passed ? "all " + std::to_string(trials) + " trials match" : "MISMATCH, see BitplaneCheck.log")
+        << std::endl;
+
+    Logger::Close();
+    return passed ? 0 : 1;
+}
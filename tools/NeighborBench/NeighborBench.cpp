@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include "CellularAutomatonRules.h"
+#include "Logger.h"
+#include "NeighborShape.h"
+#include "SummedAreaCounter.h"
+#include "TileTypeManager.h"
+#include "World.h"
+
+/// <summary>
+/// Замер стоимости подсчета соседей по всей карте мира в зависимости от радиуса:
+/// развернутые ядра против таблицы сумм по площади (результат в лог)
+/// </summary>
+class NeighborCountingBench {
+public:
+    static void Run(World& world, int maxRadius);
+};
+
+void NeighborCountingBench::Run(World& world, int maxRadius) {
+    std::lock_guard<std::recursive_mutex> lock(world.m_automatonMutex);
+    if (world.m_width <= 2 || world.m_height <= 2) return;
+
+    Logger::Log("=== NEIGHBOR COUNTING BENCHMARK: " + std::to_string(world.m_contentWidth) + "x" +
+        std::to_string(world.m_contentHeight) + ", " + std::to_string(world.m_slotCount) + " tile slots ===");
+    Logger::Log("radius | neighbors | direct ms | SAT ms (build) | SAT table KB");
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    NeighborCounts counts;
+    SummedAreaCounter counter;
+
+    // Копия с ореолом под максимальный радиус замера
+    TileGrid paddedMap = world.m_map;
+    paddedMap.SetHalo(std::max(paddedMap.GetHalo(), maxRadius));
+
+    for (int radius = 1; radius <= maxRadius; radius++) {
+        long long directChecksum = 0;
+        auto directStart = Clock::now();
+        paddedMap.Dispatch([&](auto cellTag) {
+            using Cell = decltype(cellTag);
+
+            NeighborShape::Create(NeighborShapeType::Moore, radius).Dispatch(paddedMap.GetStride(), [&](const auto& kernel) {
+                for (int y = 1; y < world.m_height - 1; y++) {
+                    const Cell* row = paddedMap.Row<Cell>(y);
+                    for (int x = 1; x < world.m_width - 1; x++) {
+                        counts.Clear(world.m_slotCount);
+                        kernel.Count(row + x, world.m_slotByTileId.data(), counts);
+                        for (int s = 0; s < world.m_slotCount; s++) directChecksum += counts.Get(s) * (s + 1);
+                    }
+                }
+            });
+        });
+        auto directEnd = Clock::now();
+
+        long long areaChecksum = 0;
+        auto areaStart = Clock::now();
+        counter.Build(world.m_map, world.m_slotByTileId, world.m_slotCount);
+        auto buildEnd = Clock::now();
+        for (int y = 1; y < world.m_height - 1; y++) {
+            for (int x = 1; x < world.m_width - 1; x++) {
+                counter.Count(x, y, radius, world.m_slotByTileId[world.m_map.Get(x, y)], counts);
+                for (int s = 0; s < world.m_slotCount; s++) areaChecksum += counts.Get(s) * (s + 1);
+            }
+        }
+        auto areaEnd = Clock::now();
+
+        int neighbors = (2 * radius + 1) * (2 * radius + 1) - 1;
+        Logger::Log(std::to_string(radius) + " | " + std::to_string(neighbors) + " | " +
+            std::to_string(elapsedMs(directStart, directEnd)) + " | " +
+            std::to_string(elapsedMs(areaStart, areaEnd)) + " (" + std::to_string(elapsedMs(areaStart, buildEnd)) + ") | " +
+            std::to_string(counter.GetMemoryBytes() / 1024) +
+            (directChecksum == areaChecksum ? "" : " | MISMATCH"));
+    }
+
+    Logger::Log("=== NEIGHBOR COUNTING BENCHMARK COMPLETE ===");
+}
+
+/// <summary>
+/// NeighborBench [maxRadius]: генерирует мир по конфигам из config/ (запускать из каталога игры)
+/// и замеряет на нем подсчет соседей для радиусов 1..maxRadius
+/// </summary>
+int main(int argc, char* argv[]) {
+    int maxRadius = argc > 1 ? std::max(1, std::atoi(argv[1])) : 8;
+
+    Logger::Initialize("NeighborBench.log");
+
+    TileTypeManager tileManager;
+    CellularAutomatonConfig automatonConfig;
+    if (!tileManager.LoadFromFile() || !automatonConfig.LoadFromFile("config/cellular_automaton.cfg")) {
+        std::cerr << "NeighborBench: failed to load configs from config/" << std::endl;
+        Logger::Close();
+        return 1;
+    }
+
+    World world;
+    world.SetTileManager(&tileManager);
+    world.SetAutomatonConfig(&automatonConfig);
+    world.GenerateFromConfig();
+
+    NeighborCountingBench::Run(world, maxRadius);
+    std::cout << "NeighborBench: radius 1.." << maxRadius << " measured, see NeighborBench.log" << std::endl;
+
+    Logger::Close();
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CellularAutomatonRules.h"
+#include "Logger.h"
+
+using namespace std;
+
+/// <summary>
+/// Символьный литерал C++ для символа тайла
+/// </summary>
+string CharLiteral(char character) {
+    if (character == '\'' || character == '\\') {
+        return string("'\\") + character + "'";
+    }
+    return string("'") + character + "'";
+}
+
+/// <summary>
+/// Строковый литерал C++ для списка символов
+/// </summary>
+string StringLiteral(const string& characters) {
+    string literal = "\"";
+    for (char character : characters) {
+        if (character == '"' || character == '\\') {
+            literal += '\\';
+        }
+        literal += character;
+    }
+    return literal + "\"";
+}
+
+/// <summary>
+/// Переводит программу стековой машины в выражение C++ с константными порогами
+/// и константными индексами символов в массиве слотов
+/// </summary>
+string TranslateRule(const RuleParser& rule, const string& characters) {
+    const vector<RuleInstruction>& program = rule.getProgram();
+    if (!rule.isValid() || program.empty()) {
+        return "false";
+    }
+
+    auto count = [&characters](char tile) {
+        return "neighborCounts.Get(slots[" + to_string(characters.find(tile)) + "])";
+    };
+    auto compareCount = [&count](const RuleInstruction& instruction, const char* op) {
+        return "(" + count(instruction.tile) + " " + op + " " + to_string(instruction.value) + ")";
+    };
+
+    vector<string> stack;
+    auto binary = [&stack](const char* op) {
+        string right = stack.back();
+        stack.pop_back();
+        stack.back() = "(" + stack.back() + " " + op + " " + right + ")";
+    };
+
+    for (const RuleInstruction& instruction : program) {
+        switch (instruction.op) {
+        case RuleOpCode::PushConst:         stack.push_back(to_string(instruction.value)); break;
+        case RuleOpCode::PushCount:         stack.push_back(count(instruction.tile)); break;
+        case RuleOpCode::CountLess:         stack.push_back(compareCount(instruction, "<")); break;
+        case RuleOpCode::CountLessEqual:    stack.push_back(compareCount(instruction, "<=")); break;
+        case RuleOpCode::CountGreater:      stack.push_back(compareCount(instruction, ">")); break;
+        case RuleOpCode::CountGreaterEqual: stack.push_back(compareCount(instruction, ">=")); break;
+        case RuleOpCode::CountEqual:        stack.push_back(compareCount(instruction, "==")); break;
+        case RuleOpCode::CountNotEqual:     stack.push_back(compareCount(instruction, "!=")); break;
+        case RuleOpCode::Less:              binary("<"); break;
+        case RuleOpCode::LessEqual:         binary("<="); break;
+        case RuleOpCode::Greater:           binary(">"); break;
+        case RuleOpCode::GreaterEqual:      binary(">="); break;
+        case RuleOpCode::Equal:             binary("=="); break;
+        case RuleOpCode::NotEqual:          binary("!="); break;
+        case RuleOpCode::And:               binary("&&"); break;
+        case RuleOpCode::Or:                binary("||"); break;
+        case RuleOpCode::Not:               stack.back() = "!" + stack.back(); break;
+        }
+    }
+
+    // Сравнения и логические операции уже дают bool, а число или count[] - правило "!= 0"
+    RuleOpCode last = program.back().op;
+    if (last == RuleOpCode::PushConst || last == RuleOpCode::PushCount) {
+        return stack.back() + " != 0";
+    }
+    const string& expression = stack.back();
+    bool binaryResult = last >= RuleOpCode::Less && last != RuleOpCode::Not;
+    return binaryResult ? expression.substr(1, expression.size() - 2) : expression;
+}
+
+/// <summary>
+/// Текст GeneratedRules.h для загруженного конфига
+/// </summary>
+string GenerateHeader(const CellularAutomatonConfig& config, const string& configPath) {
+    struct NamedRule {
+        char tile;
+        const char* key;
+        const RuleParser* rule;
+    };
+
+    // Порядок не зависит от порядка обхода unordered_map, чтобы вывод был стабильным
+    vector<NamedRule> rules;
+    for (const auto& pair : config.GetAllRules()) {
+        if (pair.second.survivalRule) rules.push_back({ pair.first, "survival", pair.second.survivalRule.get() });
+        if (pair.second.birthRule) rules.push_back({ pair.first, "birth", pair.second.birthRule.get() });
+        if (pair.second.deathRule) rules.push_back({ pair.first, "death", pair.second.deathRule.get() });
+    }
+    sort(rules.begin(), rules.end(), [](const NamedRule& a, const NamedRule& b) {
+        return a.tile != b.tile ? a.tile < b.tile : string(a.key) < string(b.key);
+    });
+
+    // Символы, которые читают правила (по возрастанию): индексы в массиве слотов сгенерированных правил
+    const string& characters = config.GetReferencedTiles();
+
+    ostringstream out;
+    out << "// Generated by tools/RuleCodegen from " << configPath << ". Do not edit by hand.\n";
+    out << "#pragma once\n";
+    out << "#include <cstdint>\n";
+    out << "#include \"CellularAutomatonRules.h\"\n\n";
+    out << "namespace GeneratedRules {\n";
+    out << "    constexpr std::uint64_t SourceHash = 0x" << hex << uppercase
+        << CellularAutomatonConfig::HashFile(configPath) << dec << nouppercase << "ULL;\n";
+    out << "    constexpr const char* Characters = " << StringLiteral(characters) << ";\n";
+
+    for (size_t i = 0; i < rules.size(); i++) {
+        out << "\n    // '" << rules[i].tile << "' " << rules[i].key << ": " << rules[i].rule->getRuleString() << "\n";
+        out << "    inline bool Rule" << i << "(const NeighborCounts& neighborCounts, const NeighborCounts::Slot* slots) {\n";
+        if (characters.empty()) {
+            out << "        (void)neighborCounts;\n";
+            out << "        (void)slots;\n";
+        }
+        out << "        return " << TranslateRule(*rules[i].rule, characters) << ";\n";
+        out << "    }\n";
+    }
+
+    out << "\n    constexpr GeneratedRuleKernel Kernels[] = {\n";
+    for (size_t i = 0; i < rules.size(); i++) {
+        out << "        { " << CharLiteral(rules[i].tile) << ", \"" << rules[i].key << "\", Rule" << i << " },\n";
+    }
+    out << "        { '\\0', nullptr, nullptr }\n";
+    out << "    };\n";
+    out << "}\n";
+    return out.str();
+}
+
+/// <summary>
+/// RuleCodegen [config] [header]: компилирует правила клеточного автомата в GeneratedRules.h.
+/// Файл перезаписывается только при изменении, чтобы не пересобирать игру без причины
+/// </summary>
+int main(int argc, char* argv[]) {
+    string configPath = argc > 1 ? argv[1] : "config/cellular_automaton.cfg";
+    string headerPath = argc > 2 ? argv[2] : "GeneratedRules.h";
+
+    Logger::Initialize("RuleCodegen.log");
+
+    CellularAutomatonConfig config;
+    if (!config.LoadFromFile(configPath)) {
+        cerr << "RuleCodegen: failed to load " << configPath << endl;
+        Logger::Close();
+        return 1;
+    }
+
+    string header = GenerateHeader(config, configPath);
+
+    ifstream existing(headerPath, ios::binary);
+    if (existing.is_open()) {
+        ostringstream current;
+        current << existing.rdbuf();
+        if (current.str() == header) {
+            cout << "RuleCodegen: " << headerPath << " is up to date" << endl;
+            Logger::Close();
+            return 0;
+        }
+        existing.close();
+    }
+
+    ofstream output(headerPath, ios::binary);
+    if (!output.is_open()) {
+        cerr << "RuleCodegen: cannot write " << headerPath << endl;
+        Logger::Close();
+        return 1;
+    }
+    output << header;
+    cout << "RuleCodegen: wrote " << config.GetAllRules().size() << " tile rules to " << headerPath << endl;
+
+    Logger::Close();
+    return 0;
+}